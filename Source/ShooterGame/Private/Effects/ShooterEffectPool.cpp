@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Effects/ShooterEffectPool.h"
+#include "Effects/ShooterPooledEffect.h"
+
+bool UShooterEffectPool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// nobody sees the effects on a dedicated server
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_DedicatedServer;
+}
+
+void UShooterEffectPool::Deinitialize()
+{
+	Pools.Reset();
+	PendingEffects.Reset();
+	RecentEffects.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UShooterEffectPool::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterEffectPool::IsTickable() const
+{
+	return PendingEffects.Num() > 0 || RecentEffects.Num() > 0;
+}
+
+TStatId UShooterEffectPool::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterEffectPool, STATGROUP_Tickables);
+}
+
+void UShooterEffectPool::SpawnEffect(TSubclassOf<AShooterPooledEffect> EffectClass, const FTransform& Transform, const FHitResult& SurfaceHit)
+{
+	if (EffectClass)
+	{
+		PendingEffects.Add(FShooterEffectRequest{EffectClass, Transform, SurfaceHit, 0.f});
+	}
+}
+
+void UShooterEffectPool::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	const float CurrentTime = World->GetTimeSeconds();
+	RecentEffects.RemoveAllSwap([CurrentTime, this](const FShooterRecentEffect& Recent)
+	{
+		return CurrentTime - Recent.PlayTime > AreaTime;
+	}, false);
+
+	if (PendingEffects.Num() == 0)
+	{
+		return;
+	}
+
+	// the budget goes to the effects closest to a local player first
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	if (ViewLocations.Num() > 0)
+	{
+		for (FShooterEffectRequest& Request : PendingEffects)
+		{
+			Request.ViewDistSq = MAX_flt;
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				Request.ViewDistSq = FMath::Min(Request.ViewDistSq, FVector::DistSquared(ViewLocation, Request.Transform.GetLocation()));
+			}
+		}
+
+		PendingEffects.Sort([](const FShooterEffectRequest& A, const FShooterEffectRequest& B)
+		{
+			return A.ViewDistSq < B.ViewDistSq;
+		});
+	}
+
+	int32 NumPlayed = 0;
+	for (const FShooterEffectRequest& Request : PendingEffects)
+	{
+		if (NumPlayed >= MaxEffectsPerFrame)
+		{
+			break;
+		}
+
+		// close enough to effects that are still playing, this one would not add anything
+		const FVector Location = Request.Transform.GetLocation();
+		if (IsAreaFull(Request.EffectClass, Location))
+		{
+			continue;
+		}
+
+		PlayEffect(Request);
+		RecentEffects.Add(FShooterRecentEffect{Request.EffectClass, Location, CurrentTime});
+		NumPlayed++;
+	}
+	PendingEffects.Reset();
+}
+
+bool UShooterEffectPool::IsAreaFull(UClass* EffectClass, const FVector& Location) const
+{
+	const float AreaRadiusSq = FMath::Square(AreaRadius);
+	int32 NumInArea = 0;
+	for (const FShooterRecentEffect& Recent : RecentEffects)
+	{
+		if (Recent.EffectClass == EffectClass && FVector::DistSquared(Recent.Location, Location) <= AreaRadiusSq)
+		{
+			if (++NumInArea >= MaxEffectsPerArea)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void UShooterEffectPool::PlayEffect(const FShooterEffectRequest& Request)
+{
+	FShooterEffectPoolList* Pool = Pools.Find(Request.EffectClass);
+	while (Pool && Pool->Effects.Num() > 0)
+	{
+		AShooterPooledEffect* Effect = Pool->Effects.Pop(false);
+		// pooled effects can still be destroyed with their level
+		if (IsValid(Effect))
+		{
+			Effect->SetActorTransform(Request.Transform);
+			Effect->SurfaceHit = Request.SurfaceHit;
+			Effect->SetActorHiddenInGame(false);
+			Effect->SetActorTickEnabled(true);
+			Effect->PlayEffect();
+			return;
+		}
+	}
+
+	AShooterPooledEffect* Effect = GetWorld()->SpawnActorDeferred<AShooterPooledEffect>(Request.EffectClass, Request.Transform);
+	if (Effect)
+	{
+		Effect->SurfaceHit = Request.SurfaceHit;
+		UGameplayStatics::FinishSpawningActor(Effect, Request.Transform);
+	}
+}
+
+void UShooterEffectPool::ReleaseEffect(AShooterPooledEffect* Effect)
+{
+	if (!IsValid(Effect))
+	{
+		return;
+	}
+
+	FShooterEffectPoolList& Pool = Pools.FindOrAdd(Effect->GetClass());
+	if (Pool.Effects.Num() >= MaxPooledEffects)
+	{
+		Effect->Destroy();
+		return;
+	}
+
+	Effect->SetActorHiddenInGame(true);
+	Effect->SetActorTickEnabled(false);
+	Pool.Effects.Add(Effect);
+}
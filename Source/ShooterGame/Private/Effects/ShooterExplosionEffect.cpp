@@ -19,15 +19,29 @@ AShooterExplosionEffect::AShooterExplosionEffect(const FObjectInitializer& Objec
 	ExplosionLight->SetVisibleFlag(true);
 
 	ExplosionLightFadeOut = 0.2f;
+	PlayTime = 0.f;
+	DefaultLightIntensity = 0.f;
 }
 
-void AShooterExplosionEffect::BeginPlay()
+void AShooterExplosionEffect::PostInitializeComponents()
 {
-	Super::BeginPlay();
+	Super::PostInitializeComponents();
+
+	// the light is faded from the intensity set up in the blueprint on every reuse
+	UPointLightComponent* DefLight = Cast<UPointLightComponent>(GetClass()->GetDefaultSubobjectByName(ExplosionLightComponentName));
+	DefaultLightIntensity = DefLight ? DefLight->Intensity : ExplosionLight->Intensity;
+}
+
+void AShooterExplosionEffect::PlayEffect()
+{
+	Super::PlayEffect();
+
+	PlayTime = GetWorld()->GetTimeSeconds();
+	ExplosionLight->SetIntensity(DefaultLightIntensity);
 
 	if (ExplosionFX)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(this, ExplosionFX, GetActorLocation(), GetActorRotation());
+		UGameplayStatics::SpawnEmitterAtLocation(this, ExplosionFX, GetActorLocation(), GetActorRotation(), FVector(1.f), true, EPSCPoolMethod::AutoRelease);
 	}
 
 	if (ExplosionSound)
@@ -51,18 +65,16 @@ void AShooterExplosionEffect::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	const float TimeAlive = GetWorld()->GetTimeSeconds() - CreationTime;
+	const float TimeAlive = GetWorld()->GetTimeSeconds() - PlayTime;
 	const float TimeRemaining = FMath::Max(0.0f, ExplosionLightFadeOut - TimeAlive);
 
 	if (TimeRemaining > 0)
 	{
 		const float FadeAlpha = 1.0f - FMath::Square(TimeRemaining / ExplosionLightFadeOut);
-
-		UPointLightComponent* DefLight = Cast<UPointLightComponent>(GetClass()->GetDefaultSubobjectByName(ExplosionLightComponentName));
-		ExplosionLight->SetIntensity(DefLight->Intensity * FadeAlpha);
+		ExplosionLight->SetIntensity(DefaultLightIntensity * FadeAlpha);
 	}
 	else
 	{
-		Destroy();
+		FinishEffect();
 	}
 }
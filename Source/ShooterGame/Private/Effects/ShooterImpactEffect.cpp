@@ -5,12 +5,11 @@
 
 AShooterImpactEffect::AShooterImpactEffect(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
-	SetAutoDestroyWhenFinished(true);
 }
 
-void AShooterImpactEffect::PostInitializeComponents()
+void AShooterImpactEffect::PlayEffect()
 {
-	Super::PostInitializeComponents();
+	Super::PlayEffect();
 
 	UPhysicalMaterial* HitPhysMat = SurfaceHit.PhysMaterial.Get();
 	EPhysicalSurface HitSurfaceType = UPhysicalMaterial::DetermineSurfaceType(HitPhysMat);
@@ -19,7 +18,7 @@ void AShooterImpactEffect::PostInitializeComponents()
 	UParticleSystem* ImpactFX = GetImpactFX(HitSurfaceType);
 	if (ImpactFX)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(this, ImpactFX, GetActorLocation(), GetActorRotation());
+		UGameplayStatics::SpawnEmitterAtLocation(this, ImpactFX, GetActorLocation(), GetActorRotation(), FVector(1.f), true, EPSCPoolMethod::AutoRelease);
 	}
 
 	// play sound
@@ -39,6 +38,9 @@ void AShooterImpactEffect::PostInitializeComponents()
 			SurfaceHit.ImpactPoint, RandomDecalRotation, EAttachLocation::KeepWorldPosition,
 			DefaultDecal.LifeSpan);
 	}
+
+	// everything above lives on its own, the actor can serve the next impact
+	FinishEffect();
 }
 
 UParticleSystem* AShooterImpactEffect::GetImpactFX(TEnumAsByte<EPhysicalSurface> SurfaceType) const
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Effects/ShooterPooledEffect.h"
+#include "Effects/ShooterEffectPool.h"
+
+AShooterPooledEffect::AShooterPooledEffect(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+}
+
+void AShooterPooledEffect::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PlayEffect();
+}
+
+void AShooterPooledEffect::PlayEffect()
+{
+}
+
+void AShooterPooledEffect::FinishEffect()
+{
+	UShooterEffectPool* EffectPool = GetWorld()->GetSubsystem<UShooterEffectPool>();
+	if (EffectPool)
+	{
+		EffectPool->ReleaseEffect(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
@@ -3,23 +3,17 @@
 #include "ShooterGame.h"
 #include "Weapons/ShooterWeapon.h"
 #include "Weapons/ShooterDamageType.h"
+#include "Weapons/StatusEffectSubsystem.h"
+#include "Player/ShooterLagCompensation.h"
+#include "Player/ShooterReplicationVisibility.h"
+#include "Player/ShooterCharacterSignificance.h"
 #include "UI/ShooterHUD.h"
 #include "Online/ShooterPlayerState.h"
 #include "Animation/AnimMontage.h"
 #include "Animation/AnimInstance.h"
 #include "Sound/SoundNodeLocalPlayer.h"
-#include "AudioThread.h"
 #include "LOGHelper.h"
 
-static int32 NetVisualizeRelevancyTestPoints = 0;
-FAutoConsoleVariableRef CVarNetVisualizeRelevancyTestPoints(
-	TEXT("p.NetVisualizeRelevancyTestPoints"),
-	NetVisualizeRelevancyTestPoints,
-	TEXT("")
-	TEXT("0: Disable, 1: Enable"),
-	ECVF_Cheat);
-
-
 static int32 NetEnablePauseRelevancy = 1;
 FAutoConsoleVariableRef CVarNetEnablePauseRelevancy(
 	TEXT("p.NetEnablePauseRelevancy"),
@@ -66,6 +60,8 @@ AShooterCharacter::AShooterCharacter(const FObjectInitializer& ObjectInitializer
 	bWantsToRun = false;
 	bWantsToFire = false;
 	LowHealthPercentage = 0.5f;
+	bLocalPlayerSounds = false;
+	Significance = EShooterCharacterSignificance::High;
 
 	BaseTurnRate = 45.f;
 	BaseLookUpRate = 45.f;
@@ -75,10 +71,28 @@ void AShooterCharacter::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 
+	UShooterCharacterMovement* ShooterMovement = Cast<UShooterCharacterMovement>(GetCharacterMovement());
+	if (ShooterMovement)
+	{
+		ShooterMovement->InitSpeedModifier(SpeedModifier);
+	}
+
+	UShooterCharacterSignificance* CharacterSignificance = GetWorld()->GetSubsystem<UShooterCharacterSignificance>();
+	if (CharacterSignificance)
+	{
+		CharacterSignificance->AddCharacter(this);
+	}
+
 	if (GetLocalRole() == ROLE_Authority)
 	{
 		Health = GetMaxHealth();
 
+		UShooterLagCompensation* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensation>();
+		if (LagCompensation)
+		{
+			LagCompensation->AddCharacter(this);
+		}
+
 		// Needs to happen after character is added to repgraph
 		GetWorldTimerManager().SetTimerForNextTick(this, &AShooterCharacter::SpawnDefaultInventory);
 	}
@@ -111,6 +125,12 @@ void AShooterCharacter::Destroyed()
 {
 	Super::Destroyed();
 	DestroyInventory();
+
+	UShooterLagCompensation* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensation>();
+	if (LagCompensation)
+	{
+		LagCompensation->RemoveCharacter(this);
+	}
 }
 
 void AShooterCharacter::PawnClientRestart()
@@ -126,6 +146,8 @@ void AShooterCharacter::PawnClientRestart()
 	// set team colors for 1st person view
 	UMaterialInstanceDynamic* Mesh1PMID = Mesh1P->CreateAndSetMaterialInstanceDynamic(0);
 	UpdateTeamColors(Mesh1PMID);
+
+	UpdateLocalPlayerSounds();
 }
 
 void AShooterCharacter::PossessedBy(class AController* InController)
@@ -134,6 +156,33 @@ void AShooterCharacter::PossessedBy(class AController* InController)
 
 	// [server] as soon as PlayerState is assigned, set team colors of this pawn for local player
 	UpdateTeamColorsAllMIDs();
+
+	UpdateLocalPlayerSounds();
+}
+
+void AShooterCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	UpdateLocalPlayerSounds();
+}
+
+void AShooterCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+
+	UpdateLocalPlayerSounds();
+}
+
+void AShooterCharacter::UpdateLocalPlayerSounds()
+{
+	const APlayerController* PC = Cast<APlayerController>(GetController());
+	const bool bLocallyControlled = (PC ? PC->IsLocalController() : false);
+	if (bLocallyControlled != bLocalPlayerSounds)
+	{
+		bLocalPlayerSounds = bLocallyControlled;
+		USoundNodeLocalPlayer::SetLocallyControlled(GetUniqueID(), bLocallyControlled);
+	}
 }
 
 void AShooterCharacter::OnRep_PlayerState()
@@ -526,7 +575,7 @@ void AShooterCharacter::ReplicateHit(float Damage, struct FDamageEvent const& Da
 	LastTakeHitInfo.ActualDamage = Damage;
 	LastTakeHitInfo.PawnInstigator = Cast<AShooterCharacter>(PawnInstigator);
 	LastTakeHitInfo.DamageCauser = DamageCauser;
-	LastTakeHitInfo.SetDamageEvent(DamageEvent);
+	LastTakeHitInfo.SetDamageEvent(DamageEvent, GetActorLocation());
 	LastTakeHitInfo.bKilled = bKilled;
 	LastTakeHitInfo.EnsureReplication();
 
@@ -535,6 +584,8 @@ void AShooterCharacter::ReplicateHit(float Damage, struct FDamageEvent const& Da
 
 void AShooterCharacter::OnRep_LastTakeHitInfo()
 {
+	LastTakeHitInfo.ResolveHitLocation(GetActorLocation());
+
 	if (LastTakeHitInfo.bKilled)
 	{
 		OnDeath(LastTakeHitInfo.ActualDamage, LastTakeHitInfo.GetDamageEvent(), LastTakeHitInfo.PawnInstigator.Get(), LastTakeHitInfo.DamageCauser.Get());
@@ -1090,7 +1141,8 @@ void AShooterCharacter::Tick(float DeltaSeconds)
 		}
 	}
 
-	if (GEngine->UseSound())
+	// nobody hears a character on a server without local players
+	if (Significance != EShooterCharacterSignificance::ServerOnly && GEngine->UseSound())
 	{
 		if (LowHealthSound)
 		{
@@ -1117,25 +1169,12 @@ void AShooterCharacter::Tick(float DeltaSeconds)
 
 		UpdateRunSounds();
 	}
+}
 
-	const APlayerController* PC = Cast<APlayerController>(GetController());
-	const bool bLocallyControlled = (PC ? PC->IsLocalController() : false);
-	const uint32 UniqueID = GetUniqueID();
-	FAudioThread::RunCommandOnAudioThread([UniqueID, bLocallyControlled]()
-	{
-	    USoundNodeLocalPlayer::GetLocallyControlledActorCache().Add(UniqueID, bLocallyControlled);
-	});
-	
-	TArray<FVector> PointsToTest;
-	BuildPauseReplicationCheckPoints(PointsToTest);
-
-	if (NetVisualizeRelevancyTestPoints == 1)
-	{
-		for (FVector PointToTest : PointsToTest)
-		{
-			DrawDebugSphere(GetWorld(), PointToTest, 10.0f, 8, FColor::Red);
-		}
-	}
+void AShooterCharacter::SetSignificance(EShooterCharacterSignificance::Type NewSignificance, float TickInterval)
+{
+	Significance = NewSignificance;
+	SetActorTickInterval(TickInterval);
 }
 
 void AShooterCharacter::BeginDestroy()
@@ -1144,11 +1183,7 @@ void AShooterCharacter::BeginDestroy()
 
 	if (!GExitPurge)
 	{
-		const uint32 UniqueID = GetUniqueID();
-		FAudioThread::RunCommandOnAudioThread([UniqueID]()
-		{
-			USoundNodeLocalPlayer::GetLocallyControlledActorCache().Remove(UniqueID);
-		});
+		USoundNodeLocalPlayer::RemoveLocallyControlled(GetUniqueID());
 	}
 }
 
@@ -1185,6 +1220,9 @@ void AShooterCharacter::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > &
 	// only to local owner: weapon change requests are locally instigated, other clients don't need it
 	DOREPLIFETIME_CONDITION(AShooterCharacter, Inventory, COND_OwnerOnly);
 
+	// only the owning client predicts its own movement
+	DOREPLIFETIME_CONDITION(AShooterCharacter, ScheduledSpeedModifier, COND_OwnerOnly);
+
 	// everyone except local owner: flag change is locally instigated
 	DOREPLIFETIME_CONDITION(AShooterCharacter, bIsTargeting, COND_SkipOwner);
 	DOREPLIFETIME_CONDITION(AShooterCharacter, bWantsToRun, COND_SkipOwner);
@@ -1203,25 +1241,9 @@ bool AShooterCharacter::IsReplicationPausedForConnection(const FNetViewer& Conne
 		APlayerController* PC = Cast<APlayerController>(ConnectionOwnerNetViewer.InViewer);
 		check(PC);
 
-		FVector ViewLocation;
-		FRotator ViewRotation;
-		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
-
-		FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(LineOfSight), true, PC->GetPawn());
-		CollisionParams.AddIgnoredActor(this);
-
-		TArray<FVector> PointsToTest;
-		BuildPauseReplicationCheckPoints(PointsToTest);
-
-		for (FVector PointToTest : PointsToTest)
-		{
-			if (!GetWorld()->LineTraceTestByChannel(PointToTest, ViewLocation, ECC_Visibility, CollisionParams))
-			{
-				return false;
-			}
-		}
-
-		return true;
+		// the line of sight is traced over several frames, the last answer is used in between
+		UShooterReplicationVisibility* ReplicationVisibility = GetWorld()->GetSubsystem<UShooterReplicationVisibility>();
+		return ReplicationVisibility && ReplicationVisibility->IsHiddenFrom(PC, this);
 	}
 
 	return false;
@@ -1280,6 +1302,13 @@ float AShooterCharacter::GetRunningSpeedModifier() const
 void AShooterCharacter::AddSpeedModifier(float Speed)
 {
 	SpeedModifier += Speed;
+
+	// the movement component hands the change to the owning client ahead of the moves it applies to
+	UShooterCharacterMovement* ShooterMovement = Cast<UShooterCharacterMovement>(GetCharacterMovement());
+	if (ShooterMovement && GetLocalRole() == ROLE_Authority)
+	{
+		ShooterMovement->ScheduleSpeedModifier(SpeedModifier);
+	}
 }
 
 float AShooterCharacter::GetSpeedModifier() const
@@ -1312,17 +1341,13 @@ float AShooterCharacter::GetLowHealthPercentage() const
 	return LowHealthPercentage;
 }
 
-void AShooterCharacter::ApplyStatusEffect(UStatusEffect* Effect)
+void AShooterCharacter::ApplyStatusEffect(const FStatusEffectData& EffectData, AShooterCharacter* EffectOwner)
 {
-	if(Effect == nullptr)
+	UStatusEffectSubsystem* StatusEffectSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UStatusEffectSubsystem>() : nullptr;
+	if(StatusEffectSubsystem)
 	{
-		return;
+		StatusEffectSubsystem->AddEffect(EffectData, EffectOwner, this);
 	}
-	ActiveStatusEffects.Add(Effect);
-	Effect->Start();
-	FTimerDelegate TimerDel;
-	TimerDel.BindUFunction(this, FName("UpdateStatusEffect"), Effect);
-	GetWorldTimerManager().SetTimer(Effect->EffectTimerHandle, TimerDel, 1.0f, true);
 }
 
 void AShooterCharacter::UpdateTeamColorsAllMIDs()
@@ -1333,22 +1358,7 @@ void AShooterCharacter::UpdateTeamColorsAllMIDs()
 	}
 }
 
-void AShooterCharacter::UpdateStatusEffect(UStatusEffect* Effect)
-{
-	if(Effect == nullptr)
-	{
-		return;
-	}
-	Effect->Update();
-	if(Effect->GetEffectData().LifeTime <= 0)
-	{
-		GetWorldTimerManager().ClearTimer(Effect->EffectTimerHandle);
-		Effect->End();
-		ActiveStatusEffects.Remove(Effect);
-	}
-}
-
-void AShooterCharacter::BuildPauseReplicationCheckPoints(TArray<FVector>& RelevancyCheckPoints)
+void AShooterCharacter::BuildPauseReplicationCheckPoints(FPauseReplicationCheckPoints& RelevancyCheckPoints) const
 {
 	FBoxSphereBounds Bounds = GetCapsuleComponent()->CalcBounds(GetCapsuleComponent()->GetComponentTransform());
 	FBox BoundingBox = Bounds.GetBox();
@@ -3,12 +3,26 @@
 #include "ShooterGame.h"
 #include "Player/ShooterCharacterMovement.h"
 
+/** Upper bound for how far ahead of the client a speed modifier change is scheduled */
+static const float MaxSpeedModifierLeadTime = 0.3f;
+
+/** Added to the ping so the change arrives on the client before it is due */
+static const float SpeedModifierLeadMargin = 0.03f;
+
+float FScheduledSpeedModifier::GetModifierAt(float MoveTimeStamp) const
+{
+	// a change that seems too far ahead was scheduled before the client reset its time stamps
+	const bool bChanged = MoveTimeStamp >= TimeStamp || TimeStamp - MoveTimeStamp > MaxSpeedModifierLeadTime;
+	return bChanged ? Modifier : PreviousModifier;
+}
+
 //----------------------------------------------------------------------//
 // UPawnMovementComponent
 //----------------------------------------------------------------------//
 UShooterCharacterMovement::UShooterCharacterMovement(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	MoveTimeStamp = -1.f;
 }
 
 
@@ -28,8 +42,100 @@ float UShooterCharacterMovement::GetMaxSpeed() const
 			MaxSpeed *= ShooterCharacterOwner->GetRunningSpeedModifier();
 		}
 
-		MaxSpeed *= ShooterCharacterOwner->GetSpeedModifier();
+		MaxSpeed *= GetCurrentSpeedModifier();
 	}
 
 	return MaxSpeed;
 }
+
+void UShooterCharacterMovement::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	TGuardValue<float> MoveTimeStampGuard(MoveTimeStamp, ClientTimeStamp);
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+void UShooterCharacterMovement::InitSpeedModifier(float Modifier)
+{
+	FScheduledSpeedModifier* ScheduledSpeedModifier = GetScheduledSpeedModifier();
+	if (ScheduledSpeedModifier)
+	{
+		ScheduledSpeedModifier->PreviousModifier = Modifier;
+		ScheduledSpeedModifier->Modifier = Modifier;
+		ScheduledSpeedModifier->TimeStamp = 0.f;
+	}
+}
+
+void UShooterCharacterMovement::ScheduleSpeedModifier(float Modifier)
+{
+	FScheduledSpeedModifier* ScheduledSpeedModifier = GetScheduledSpeedModifier();
+	if (ScheduledSpeedModifier == nullptr || !IsSpeedModifierPredicted())
+	{
+		InitSpeedModifier(Modifier);
+		return;
+	}
+
+	// the client runs about one round trip ahead of the moves we receive from it,
+	// schedule the change far enough ahead that it arrives before the client reaches it
+	float LeadTime = SpeedModifierLeadMargin;
+	const APlayerState* OwnerPlayerState = PawnOwner ? PawnOwner->GetPlayerState() : nullptr;
+	if (OwnerPlayerState)
+	{
+		LeadTime += OwnerPlayerState->ExactPing * 0.001f;
+	}
+
+	const float CurrentTimeStamp = GetSpeedModifierTimeStamp();
+	ScheduledSpeedModifier->PreviousModifier = ScheduledSpeedModifier->GetModifierAt(CurrentTimeStamp);
+	ScheduledSpeedModifier->Modifier = Modifier;
+	ScheduledSpeedModifier->TimeStamp = CurrentTimeStamp + FMath::Min(LeadTime, MaxSpeedModifierLeadTime);
+}
+
+float UShooterCharacterMovement::GetCurrentSpeedModifier() const
+{
+	const FScheduledSpeedModifier* ScheduledSpeedModifier = GetScheduledSpeedModifier();
+	if (ScheduledSpeedModifier == nullptr)
+	{
+		return 1.f;
+	}
+
+	if (!IsSpeedModifierPredicted())
+	{
+		return ScheduledSpeedModifier->Modifier;
+	}
+
+	return ScheduledSpeedModifier->GetModifierAt(GetSpeedModifierTimeStamp());
+}
+
+bool UShooterCharacterMovement::IsSpeedModifierPredicted() const
+{
+	if (CharacterOwner == nullptr)
+	{
+		return false;
+	}
+
+	return CharacterOwner->GetLocalRole() == ROLE_AutonomousProxy
+		|| (CharacterOwner->GetLocalRole() == ROLE_Authority && CharacterOwner->GetRemoteRole() == ROLE_AutonomousProxy && !CharacterOwner->IsLocallyControlled());
+}
+
+float UShooterCharacterMovement::GetSpeedModifierTimeStamp() const
+{
+	if (MoveTimeStamp >= 0.f)
+	{
+		return MoveTimeStamp;
+	}
+
+	if (CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_Authority)
+	{
+		const FNetworkPredictionData_Server_Character* ServerData = GetPredictionData_Server_Character();
+		return ServerData ? ServerData->CurrentClientTimeStamp : 0.f;
+	}
+
+	const FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
+	return ClientData ? ClientData->CurrentTimeStamp : 0.f;
+}
+
+FScheduledSpeedModifier* UShooterCharacterMovement::GetScheduledSpeedModifier() const
+{
+	// replicated with the character, the movement component itself is not replicated
+	AShooterCharacter* ShooterCharacterOwner = Cast<AShooterCharacter>(CharacterOwner);
+	return ShooterCharacterOwner ? &ShooterCharacterOwner->GetScheduledSpeedModifier() : nullptr;
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Player/ShooterCharacterSignificance.h"
+
+/** Time in seconds a character counts as on screen after it was last rendered */
+static const float SignificanceRenderedTime = 0.2f;
+
+bool UShooterCharacterSignificance::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterCharacterSignificance::Deinitialize()
+{
+	Characters.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UShooterCharacterSignificance::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterCharacterSignificance::IsTickable() const
+{
+	return Characters.Num() > 0;
+}
+
+TStatId UShooterCharacterSignificance::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterCharacterSignificance, STATGROUP_Tickables);
+}
+
+void UShooterCharacterSignificance::AddCharacter(AShooterCharacter* Character)
+{
+	if (Character)
+	{
+		Characters.AddUnique(Character);
+	}
+}
+
+void UShooterCharacterSignificance::Tick(float DeltaTime)
+{
+	UpdateAccumulator += DeltaTime;
+	if (UpdateAccumulator < UpdateInterval)
+	{
+		return;
+	}
+	UpdateAccumulator = 0.f;
+
+	Characters.RemoveAllSwap([](const TWeakObjectPtr<AShooterCharacter>& Character)
+	{
+		return !Character.IsValid();
+	}, false);
+
+	UWorld* World = GetWorld();
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	for (const TWeakObjectPtr<AShooterCharacter>& Character : Characters)
+	{
+		const EShooterCharacterSignificance::Type Significance = GetSignificance(Character.Get(), ViewLocations);
+		if (Significance != Character->GetSignificance())
+		{
+			Character->SetSignificance(Significance, GetTickInterval(Significance));
+		}
+	}
+}
+
+EShooterCharacterSignificance::Type UShooterCharacterSignificance::GetSignificance(const AShooterCharacter* Character, const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const
+{
+	if (ViewLocations.Num() == 0)
+	{
+		return EShooterCharacterSignificance::ServerOnly;
+	}
+
+	if (Character->IsLocallyControlled())
+	{
+		return EShooterCharacterSignificance::High;
+	}
+
+	float MinDistanceSq = MAX_flt;
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		MinDistanceSq = FMath::Min(MinDistanceSq, FVector::DistSquared(ViewLocation, Character->GetActorLocation()));
+	}
+
+	const bool bRendered = Character->GetMesh() && Character->GetMesh()->WasRecentlyRendered(SignificanceRenderedTime);
+	if (bRendered && MinDistanceSq <= FMath::Square(HighDistance))
+	{
+		return EShooterCharacterSignificance::High;
+	}
+	if (bRendered || MinDistanceSq <= FMath::Square(MediumDistance))
+	{
+		return EShooterCharacterSignificance::Medium;
+	}
+	return EShooterCharacterSignificance::Low;
+}
+
+float UShooterCharacterSignificance::GetTickInterval(EShooterCharacterSignificance::Type Significance) const
+{
+	switch (Significance)
+	{
+		case EShooterCharacterSignificance::Medium:		return MediumTickInterval;
+		case EShooterCharacterSignificance::Low:		return LowTickInterval;
+		case EShooterCharacterSignificance::ServerOnly:	return ServerOnlyTickInterval;
+		default:										return 0.f;
+	}
+}
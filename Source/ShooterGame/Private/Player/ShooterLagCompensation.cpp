@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Player/ShooterLagCompensation.h"
+
+int32 FLagCompensationStorage::Add(AShooterCharacter* Character, int32 HistoryLength)
+{
+	Heads.Add(0);
+	Counts.Add(0);
+	SampleTimes.AddZeroed(HistoryLength);
+	SampleCenters.AddZeroed(HistoryLength);
+	SampleExtents.AddZeroed(HistoryLength);
+	return Characters.Add(Character);
+}
+
+void FLagCompensationStorage::RemoveAtSwap(int32 Index, int32 HistoryLength)
+{
+	const int32 LastIndex = Characters.Num() - 1;
+	if (Index != LastIndex)
+	{
+		// move the samples of the last character into the freed block
+		FMemory::Memcpy(&SampleTimes[Index * HistoryLength], &SampleTimes[LastIndex * HistoryLength], HistoryLength * sizeof(float));
+		FMemory::Memcpy(&SampleCenters[Index * HistoryLength], &SampleCenters[LastIndex * HistoryLength], HistoryLength * sizeof(FVector));
+		FMemory::Memcpy(&SampleExtents[Index * HistoryLength], &SampleExtents[LastIndex * HistoryLength], HistoryLength * sizeof(FVector));
+	}
+	SampleTimes.RemoveAt(LastIndex * HistoryLength, HistoryLength, false);
+	SampleCenters.RemoveAt(LastIndex * HistoryLength, HistoryLength, false);
+	SampleExtents.RemoveAt(LastIndex * HistoryLength, HistoryLength, false);
+
+	Characters.RemoveAtSwap(Index, 1, false);
+	Heads.RemoveAtSwap(Index, 1, false);
+	Counts.RemoveAtSwap(Index, 1, false);
+}
+
+void FLagCompensationStorage::Reset()
+{
+	Characters.Reset();
+	Heads.Reset();
+	Counts.Reset();
+	SampleTimes.Reset();
+	SampleCenters.Reset();
+	SampleExtents.Reset();
+}
+
+bool UShooterLagCompensation::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// hits are only verified by the server
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+void UShooterLagCompensation::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// two samples are needed to blend between
+	HistoryLength = FMath::Max(HistoryLength, 2);
+}
+
+void UShooterLagCompensation::Deinitialize()
+{
+	CharacterSlots.Reset();
+	Storage.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UShooterLagCompensation::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterLagCompensation::IsTickable() const
+{
+	return Storage.Num() > 0;
+}
+
+TStatId UShooterLagCompensation::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterLagCompensation, STATGROUP_Tickables);
+}
+
+void UShooterLagCompensation::AddCharacter(AShooterCharacter* Character)
+{
+	if (Character && !CharacterSlots.Contains(Character))
+	{
+		CharacterSlots.Add(Character, Storage.Add(Character, HistoryLength));
+	}
+}
+
+void UShooterLagCompensation::RemoveCharacter(AShooterCharacter* Character)
+{
+	const int32* Slot = CharacterSlots.Find(Character);
+	if (Slot)
+	{
+		RemoveSlot(*Slot);
+	}
+}
+
+void UShooterLagCompensation::RemoveSlot(int32 Slot)
+{
+	const int32 LastSlot = Storage.Num() - 1;
+	Storage.RemoveAtSwap(Slot, HistoryLength);
+
+	// the last character took the freed slot
+	for (TMap<const AShooterCharacter*, int32>::TIterator It = CharacterSlots.CreateIterator(); It; ++It)
+	{
+		if (It.Value() == Slot)
+		{
+			It.RemoveCurrent();
+		}
+		else if (It.Value() == LastSlot)
+		{
+			It.Value() = Slot;
+		}
+	}
+}
+
+void UShooterLagCompensation::Tick(float DeltaTime)
+{
+	// characters that went away without removing themselves
+	for (int32 Slot = Storage.Num() - 1; Slot >= 0; Slot--)
+	{
+		if (!Storage.Characters[Slot].IsValid())
+		{
+			RemoveSlot(Slot);
+		}
+	}
+
+	RecordSamples();
+}
+
+void UShooterLagCompensation::RecordSamples()
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	for (int32 Slot = 0; Slot < Storage.Num(); Slot++)
+	{
+		const AShooterCharacter* Character = Storage.Characters[Slot].Get();
+
+		// the bounds are already kept up to date by the components, no need to gather them again
+		FBox HitBox = Character->GetCapsuleComponent()->Bounds.GetBox();
+		if (Character->GetMesh())
+		{
+			HitBox += Character->GetMesh()->Bounds.GetBox();
+		}
+
+		const int32 Head = (Storage.Heads[Slot] + 1) % HistoryLength;
+		const int32 SampleIndex = Slot * HistoryLength + Head;
+		Storage.SampleTimes[SampleIndex] = CurrentTime;
+		Storage.SampleCenters[SampleIndex] = HitBox.GetCenter();
+		Storage.SampleExtents[SampleIndex] = HitBox.GetExtent();
+		Storage.Heads[Slot] = Head;
+		Storage.Counts[Slot] = FMath::Min(Storage.Counts[Slot] + 1, HistoryLength);
+	}
+}
+
+float UShooterLagCompensation::GetClientTime(const APawn* Shooter) const
+{
+	// the shooter saw the other characters about half a round trip late, and the shot took the other half to arrive
+	float RewindTime = 0.f;
+	const APlayerState* ShooterPlayerState = Shooter ? Shooter->GetPlayerState() : nullptr;
+	if (ShooterPlayerState)
+	{
+		RewindTime = FMath::Min(ShooterPlayerState->ExactPing * 0.001f, MaxRewindTime);
+	}
+	return GetWorld()->GetTimeSeconds() - RewindTime;
+}
+
+bool UShooterLagCompensation::GetHitBoxAt(const AShooterCharacter* Character, float Time, FBox& OutHitBox) const
+{
+	const int32* Slot = CharacterSlots.Find(Character);
+	if (Slot == nullptr || Storage.Counts[*Slot] == 0)
+	{
+		return false;
+	}
+
+	const int32 BlockStart = *Slot * HistoryLength;
+	const int32 Head = Storage.Heads[*Slot];
+
+	// walk back from the newest sample to the first one at or before Time
+	int32 NewerIndex = BlockStart + Head;
+	for (int32 Age = 0; Age < Storage.Counts[*Slot]; Age++)
+	{
+		const int32 SampleIndex = BlockStart + (Head - Age + HistoryLength) % HistoryLength;
+		if (Storage.SampleTimes[SampleIndex] <= Time)
+		{
+			// blend with the next newer sample, the hit happened somewhere between the two
+			const float NewerTime = Storage.SampleTimes[NewerIndex];
+			const float SampleTime = Storage.SampleTimes[SampleIndex];
+			const float Alpha = NewerTime > SampleTime ? FMath::Clamp((Time - SampleTime) / (NewerTime - SampleTime), 0.f, 1.f) : 0.f;
+			const FVector Center = FMath::Lerp(Storage.SampleCenters[SampleIndex], Storage.SampleCenters[NewerIndex], Alpha);
+			const FVector Extent = FMath::Lerp(Storage.SampleExtents[SampleIndex], Storage.SampleExtents[NewerIndex], Alpha);
+			OutHitBox = FBox::BuildAABB(Center, Extent);
+			return true;
+		}
+		NewerIndex = SampleIndex;
+	}
+
+	// older than the history, use the oldest sample
+	OutHitBox = FBox::BuildAABB(Storage.SampleCenters[NewerIndex], Storage.SampleExtents[NewerIndex]);
+	return true;
+}
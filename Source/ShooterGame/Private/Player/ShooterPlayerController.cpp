@@ -20,7 +20,6 @@
 #include "ShooterLeaderboards.h"
 #include "ShooterGameViewportClient.h"
 #include "Sound/SoundNodeLocalPlayer.h"
-#include "AudioThread.h"
 #include "OnlineSubsystemUtils.h"
 
 #define  ACH_FRAG_SOMEONE	TEXT("ACH_FRAG_SOMEONE")
@@ -158,13 +157,6 @@ void AShooterPlayerController::TickActor(float DeltaTime, enum ELevelTick TickTy
 			}
 		}
 	}
-
-	const bool bLocallyControlled = IsLocalController();
-	const uint32 UniqueID = GetUniqueID();
-	FAudioThread::RunCommandOnAudioThread([UniqueID, bLocallyControlled]()
-	{
-		USoundNodeLocalPlayer::GetLocallyControlledActorCache().Add(UniqueID, bLocallyControlled);
-	});
 };
 
 void AShooterPlayerController::BeginDestroy()
@@ -177,11 +169,7 @@ void AShooterPlayerController::BeginDestroy()
 
 	if (!GExitPurge)
 	{
-		const uint32 UniqueID = GetUniqueID();
-		FAudioThread::RunCommandOnAudioThread([UniqueID]()
-		{
-			USoundNodeLocalPlayer::GetLocallyControlledActorCache().Remove(UniqueID);
-		});
+		USoundNodeLocalPlayer::RemoveLocallyControlled(GetUniqueID());
 	}
 }
 
@@ -189,6 +177,9 @@ void AShooterPlayerController::SetPlayer( UPlayer* InPlayer )
 {
 	Super::SetPlayer( InPlayer );
 
+	// a controller only becomes local when it gets its player
+	USoundNodeLocalPlayer::SetLocallyControlled(GetUniqueID(), IsLocalController());
+
 	if (ULocalPlayer* const LocalPlayer = Cast<ULocalPlayer>(Player))
 	{
 		//Build menu only after game is initialized
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Player/ShooterRelevancyDebug.h"
+
+#include "DrawDebugHelpers.h"
+#include "EngineUtils.h"
+
+static int32 NetVisualizeRelevancyTestPoints = 0;
+FAutoConsoleVariableRef CVarNetVisualizeRelevancyTestPoints(
+	TEXT("p.NetVisualizeRelevancyTestPoints"),
+	NetVisualizeRelevancyTestPoints,
+	TEXT("")
+	TEXT("0: Disable, 1: Enable"),
+	ECVF_Cheat);
+
+bool UShooterRelevancyDebug::ShouldCreateSubsystem(UObject* Outer) const
+{
+#if ENABLE_DRAW_DEBUG
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+#else
+	return false;
+#endif
+}
+
+ETickableTickType UShooterRelevancyDebug::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterRelevancyDebug::IsTickable() const
+{
+	return NetVisualizeRelevancyTestPoints == 1;
+}
+
+TStatId UShooterRelevancyDebug::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterRelevancyDebug, STATGROUP_Tickables);
+}
+
+void UShooterRelevancyDebug::Tick(float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	FPauseReplicationCheckPoints PointsToTest;
+	for (TActorIterator<AShooterCharacter> It(World); It; ++It)
+	{
+		PointsToTest.Reset();
+		It->BuildPauseReplicationCheckPoints(PointsToTest);
+
+		for (const FVector& PointToTest : PointsToTest)
+		{
+			DrawDebugSphere(World, PointToTest, 10.0f, 8, FColor::Red);
+		}
+	}
+}
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Player/ShooterReplicationVisibility.h"
+
+static int32 NetPauseRelevancyAsyncTraces = 0;
+FAutoConsoleVariableRef CVarNetPauseRelevancyAsyncTraces(
+	TEXT("p.NetPauseRelevancyAsyncTraces"),
+	NetPauseRelevancyAsyncTraces,
+	TEXT("Refresh the visibility used to pause replication with async traces, the previous answer is used until they finish\n")
+	TEXT("0: Sync, 1: Async"),
+	ECVF_Default);
+
+bool UShooterReplicationVisibility::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// replication is only paused by the server
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+void UShooterReplicationVisibility::Deinitialize()
+{
+	Entries.Reset();
+	EntryIndices.Reset();
+	InFlightKeys.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UShooterReplicationVisibility::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterReplicationVisibility::IsTickable() const
+{
+	return Entries.Num() > 0;
+}
+
+TStatId UShooterReplicationVisibility::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterReplicationVisibility, STATGROUP_Tickables);
+}
+
+bool UShooterReplicationVisibility::IsHiddenFrom(APlayerController* Viewer, AShooterCharacter* Target)
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const FReplicationVisibilityKey Key(Viewer, Target);
+	const int32* Index = EntryIndices.Find(Key);
+	if (Index && Entries[*Index].Viewer.Get() == Viewer && Entries[*Index].Target.Get() == Target)
+	{
+		FReplicationVisibilityEntry& Entry = Entries[*Index];
+		Entry.QueryTime = CurrentTime;
+		return Entry.bHidden;
+	}
+
+	// new pair, or the entry of a destroyed pair at the same addresses
+	FReplicationVisibilityEntry& Entry = Index ? Entries[*Index] : Entries.AddDefaulted_GetRef();
+	if (Index == nullptr)
+	{
+		EntryIndices.Add(Key, Entries.Num() - 1);
+	}
+	Entry.Key = Key;
+	Entry.PendingTraces.Reset();
+	Entry.Viewer = Viewer;
+	Entry.Target = Target;
+	Entry.bHidden = false;
+	Entry.UpdateTime = -MAX_flt;
+	Entry.QueryTime = CurrentTime;
+	Entry.IssuedFrame = 0;
+	return false;
+}
+
+void UShooterReplicationVisibility::RemoveEntry(int32 Index)
+{
+	EntryIndices.Remove(Entries[Index].Key);
+
+	const int32 LastIndex = Entries.Num() - 1;
+	if (Index != LastIndex)
+	{
+		EntryIndices.Add(Entries[LastIndex].Key, Index);
+	}
+	Entries.RemoveAtSwap(Index, 1, false);
+}
+
+void UShooterReplicationVisibility::Tick(float DeltaTime)
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+	// pairs that are gone or that replication doesn't ask about anymore
+	for (int32 Index = Entries.Num() - 1; Index >= 0; Index--)
+	{
+		const FReplicationVisibilityEntry& Entry = Entries[Index];
+		if (!Entry.Viewer.IsValid() || !Entry.Target.IsValid() || CurrentTime - Entry.QueryTime > EntryTimeout)
+		{
+			RemoveEntry(Index);
+		}
+	}
+
+	// results are only kept for a frame, collect them before the budget is spent on new traces
+	CollectAsyncRefreshes();
+	RefreshEntries(CurrentTime);
+}
+
+void UShooterReplicationVisibility::CollectAsyncRefreshes()
+{
+	for (int32 KeyIndex = InFlightKeys.Num() - 1; KeyIndex >= 0; KeyIndex--)
+	{
+		// the entry may have been removed or reused for a new pair since its traces were issued
+		const int32* Index = EntryIndices.Find(InFlightKeys[KeyIndex]);
+		FReplicationVisibilityEntry* Entry = Index ? &Entries[*Index] : nullptr;
+		if (Entry && Entry->PendingTraces.Num() > 0)
+		{
+			FinishAsyncRefresh(*Entry);
+		}
+
+		// the traces finished or expired and were dropped
+		if (Entry == nullptr || Entry->PendingTraces.Num() == 0)
+		{
+			InFlightKeys.RemoveAtSwap(KeyIndex, 1, false);
+		}
+	}
+}
+
+void UShooterReplicationVisibility::RefreshEntries(float CurrentTime)
+{
+	int32 TraceBudget = MaxTracesPerFrame;
+	for (int32 Step = 0; Step < Entries.Num() && TraceBudget > 0; Step++)
+	{
+		RefreshCursor = RefreshCursor < Entries.Num() ? RefreshCursor : 0;
+		FReplicationVisibilityEntry& Entry = Entries[RefreshCursor++];
+
+		// entries in flight are collected by CollectAsyncRefreshes
+		if (Entry.PendingTraces.Num() == 0 && CurrentTime - Entry.UpdateTime >= RefreshInterval)
+		{
+			TraceBudget -= RefreshEntry(Entry, CurrentTime);
+		}
+	}
+}
+
+int32 UShooterReplicationVisibility::RefreshEntry(FReplicationVisibilityEntry& Entry, float CurrentTime)
+{
+	APlayerController* Viewer = Entry.Viewer.Get();
+	AShooterCharacter* Target = Entry.Target.Get();
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Viewer->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(LineOfSight), true, Viewer->GetPawn());
+	CollisionParams.AddIgnoredActor(Target);
+
+	FPauseReplicationCheckPoints PointsToTest;
+	Target->BuildPauseReplicationCheckPoints(PointsToTest);
+
+	Entry.UpdateTime = CurrentTime;
+	if (NetPauseRelevancyAsyncTraces != 0)
+	{
+		Entry.IssuedFrame = GFrameCounter;
+		for (const FVector& PointToTest : PointsToTest)
+		{
+			Entry.PendingTraces.Add(GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, PointToTest, ViewLocation, ECC_Visibility, CollisionParams));
+		}
+		if (Entry.PendingTraces.Num() > 0)
+		{
+			InFlightKeys.Add(Entry.Key);
+		}
+		return PointsToTest.Num();
+	}
+
+	// hidden only if every point is blocked, the first visible one answers it
+	int32 NumTraces = 0;
+	Entry.bHidden = true;
+	for (const FVector& PointToTest : PointsToTest)
+	{
+		NumTraces++;
+		if (!GetWorld()->LineTraceTestByChannel(PointToTest, ViewLocation, ECC_Visibility, CollisionParams))
+		{
+			Entry.bHidden = false;
+			break;
+		}
+	}
+	return NumTraces;
+}
+
+bool UShooterReplicationVisibility::FinishAsyncRefresh(FReplicationVisibilityEntry& Entry)
+{
+	bool bHidden = true;
+	for (const FTraceHandle& TraceHandle : Entry.PendingTraces)
+	{
+		FTraceDatum TraceData;
+		if (!GetWorld()->QueryTraceData(TraceHandle, TraceData))
+		{
+			// results are only kept for one frame, traces we missed have to be issued again
+			if (GFrameCounter > Entry.IssuedFrame + 1)
+			{
+				Entry.PendingTraces.Reset();
+				Entry.UpdateTime = -MAX_flt;
+			}
+			return false;
+		}
+
+		bHidden &= FHitResult::GetFirstBlockingHit(TraceData.OutHits) != nullptr;
+	}
+
+	Entry.bHidden = bHidden;
+	Entry.PendingTraces.Reset();
+	return true;
+}
@@ -3,6 +3,7 @@
 #include "ShooterGame.h"
 #include "Sound/SoundNodeLocalPlayer.h"
 #include "SoundDefinitions.h"
+#include "AudioThread.h"
 
 #define LOCTEXT_NAMESPACE "SoundNodeLocalPlayer"
 
@@ -12,6 +13,22 @@ USoundNodeLocalPlayer::USoundNodeLocalPlayer(const FObjectInitializer& ObjectIni
 {
 }
 
+void USoundNodeLocalPlayer::SetLocallyControlled(uint32 ActorID, bool bLocallyControlled)
+{
+	FAudioThread::RunCommandOnAudioThread([ActorID, bLocallyControlled]()
+	{
+		LocallyControlledActorCache.Add(ActorID, bLocallyControlled);
+	});
+}
+
+void USoundNodeLocalPlayer::RemoveLocallyControlled(uint32 ActorID)
+{
+	FAudioThread::RunCommandOnAudioThread([ActorID]()
+	{
+		LocallyControlledActorCache.Remove(ActorID);
+	});
+}
+
 void USoundNodeLocalPlayer::ParseNodes(FAudioDevice* AudioDevice, const UPTRINT NodeWaveInstanceHash, FActiveSound& ActiveSound, const FSoundParseParameters& ParseParams, TArray<FWaveInstance*>& WaveInstances)
 {
 	bool bLocallyControlled = false;
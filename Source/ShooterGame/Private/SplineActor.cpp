@@ -54,103 +54,226 @@ void ASplineActor::UpdateSpline()
 		return;
 	}
 
-	for(int i = SplineComponent->GetNumChildrenComponents()-1; i >= 0; i--)
+	// construction script reruns destroy the components we made, drop them from the pool
+	SplineMeshPool.RemoveAll([](const USplineMeshComponent* SplineMesh)
 	{
-		USceneComponent* ChildComp = SplineComponent->GetChildComponent(i);
-		if(ChildComp)
+		return SplineMesh == nullptr || SplineMesh->IsPendingKill();
+	});
+	for(auto It = InstancedMeshes.CreateIterator(); It; ++It)
+	{
+		if(It.Value() == nullptr || It.Value()->IsPendingKill())
 		{
-			ChildComp->DestroyComponent();
+			It.RemoveCurrent();
 		}
 	}
 
-	if(SplineComponent && SplineMeshMap.Num() > 0)
+	const int32 SplinePointCount = SplineComponent->GetNumberOfSplinePoints();
+	for(int i = 0; i < SplinePointCount-1 ; i++)
+	{
+		SplineComponent->SetSplinePointType(i,ESplinePointType::Linear,false);
+		SplineComponent->SetTangentsAtSplinePoint(i, FVector::ZeroVector, FVector::ZeroVector, ESplineCoordinateSpace::Local, false);
+	}
+
+	// only one of the render modes has anything to show
+	UpdateSplineMeshes(RenderMode == ESplineRenderMode::SplineMeshes ? SplinePointCount-1 : 0);
+	UpdateInstancedMeshes(RenderMode == ESplineRenderMode::InstancedMeshes ? SplinePointCount-1 : 0);
+
+	SplineComponent->UpdateSpline();
+}
+
+UInstancedStaticMeshComponent* ASplineActor::GetInstancedMesh(ESplineMeshType Type) const
+{
+	UInstancedStaticMeshComponent* const* InstancedMesh = InstancedMeshes.Find(Type);
+	return InstancedMesh ? *InstancedMesh : nullptr;
+}
+
+const FSplineMeshDetails* ASplineActor::GetSegmentMeshDetails(int32 Segment, int32 SegmentCount, ESplineMeshType& OutType) const
+{
+	const FSplineMeshDetails* StartMeshDetails = SplineMeshMap.Find(ESplineMeshType::Start);
+	const FSplineMeshDetails* EndMeshDetails = SplineMeshMap.Find(ESplineMeshType::End);
+	const FSplineMeshDetails* DefaultMeshDetails = SplineMeshMap.Find(ESplineMeshType::Default);
+
+	// we need a default mesh to work with
+	if(DefaultMeshDetails == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Start of spline
+	if(StartMeshDetails && StartMeshDetails->Mesh && Segment == 0)
+	{
+		OutType = ESplineMeshType::Start;
+		return StartMeshDetails;
+	}
+	// End of spline
+	if(EndMeshDetails && EndMeshDetails->Mesh && SegmentCount > 1 && Segment == SegmentCount - 1)
+	{
+		OutType = ESplineMeshType::End;
+		return EndMeshDetails;
+	}
+	//Middle/Default spline
+	OutType = ESplineMeshType::Default;
+	return DefaultMeshDetails;
+}
+
+void ASplineActor::UpdateSplineMeshes(int32 SegmentCount)
+{
+	int32 UsedSplineMeshCount = 0;
+
+	for(int i = 0; i < SegmentCount ; i++)
 	{
-		FSplineMeshDetails* StartMeshDetails = nullptr;
-		if(SplineMeshMap.Contains(ESplineMeshType::Start))
+		ESplineMeshType MeshType;
+		const FSplineMeshDetails* MeshDetails = GetSegmentMeshDetails(i, SegmentCount, MeshType);
+		if(MeshDetails == nullptr)
 		{
-			StartMeshDetails = SplineMeshMap.Find(ESplineMeshType::Start);  
+			break;
 		}
-		
-		FSplineMeshDetails* EndMeshDetails = nullptr;
-		if(SplineMeshMap.Contains(ESplineMeshType::End))
+
+		USplineMeshComponent* SplineMesh = GetPooledSplineMesh(UsedSplineMeshCount);
+		if(SplineMesh == nullptr)
 		{
-			EndMeshDetails = SplineMeshMap.Find(ESplineMeshType::End);
+			continue;
 		}
+		UsedSplineMeshCount++;
 
-		FSplineMeshDetails* DefaultMeshDetails = nullptr;
-		if(SplineMeshMap.Contains(ESplineMeshType::Default))
+		// pooled meshes usually keep their role, only touch the render state when it changes
+		SplineMesh->SetStaticMesh(MeshDetails->Mesh);
+		if(SplineMesh->ForwardAxis != MeshDetails->ForwardAxis)
 		{
-			DefaultMeshDetails = SplineMeshMap.Find(ESplineMeshType::Default);  
+			SplineMesh->SetForwardAxis(MeshDetails->ForwardAxis, false);
 		}
-		else
+		if(SplineMesh->GetMaterial(0) != MeshDetails->Material)
 		{
-			// exit if we don't have a default mesh to work with
-			return;
+			SplineMesh->SetMaterial(0, MeshDetails->Material);
 		}
 
-		if(DefaultMeshDetails == nullptr)
+		const FVector StartPoint = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Type::Local);
+		const FVector StartTangent = SplineComponent->GetTangentAtSplinePoint(i, ESplineCoordinateSpace::Type::Local);
+		const FVector EndPoint = SplineComponent->GetLocationAtSplinePoint(i + 1, ESplineCoordinateSpace::Type::Local);
+		const FVector EndTangent = SplineComponent->GetTangentAtSplinePoint(i + 1, ESplineCoordinateSpace::Type::Local);
+		SplineMesh->SetStartAndEnd(StartPoint, StartTangent, EndPoint, EndTangent, true);
+		SplineMesh->SetVisibility(true);
+	}
+
+	// keep the meshes we did not need for longer paths, hidden
+	for(int32 Index = UsedSplineMeshCount; Index < SplineMeshPool.Num(); Index++)
+	{
+		SplineMeshPool[Index]->SetVisibility(false);
+	}
+}
+
+void ASplineActor::UpdateInstancedMeshes(int32 SegmentCount)
+{
+	TMap<ESplineMeshType, TArray<FTransform>> InstanceTransforms;
+
+	for(int i = 0; i < SegmentCount ; i++)
+	{
+		ESplineMeshType MeshType;
+		const FSplineMeshDetails* MeshDetails = GetSegmentMeshDetails(i, SegmentCount, MeshType);
+		if(MeshDetails == nullptr)
 		{
-			return;
+			break;
+		}
+		if(MeshDetails->Mesh == nullptr)
+		{
+			continue;
 		}
 
-		int SplinePointCount = SplineComponent->GetNumberOfSplinePoints();
-		UStaticMesh* StaticMesh = DefaultMeshDetails->Mesh;
-		UMaterialInterface* Material = nullptr;
-		ESplineMeshAxis::Type ForwardAxis = DefaultMeshDetails->ForwardAxis;
+		// segments are straight, stretch the mesh along its forward axis from one point to the next
+		const FVector StartPoint = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Type::Local);
+		const FVector EndPoint = SplineComponent->GetLocationAtSplinePoint(i + 1, ESplineCoordinateSpace::Type::Local);
+		const FVector Segment = EndPoint - StartPoint;
+		const FVector Direction = Segment.GetSafeNormal();
+		const FBox MeshBounds = MeshDetails->Mesh->GetBoundingBox();
 
-		for(int i = 0; i < SplinePointCount-1 ; i++)
+		FRotator Rotation;
+		FVector Scale(1.f);
+		float MeshStart;
+		switch(MeshDetails->ForwardAxis)
 		{
-			USplineMeshComponent* SplineMesh = NewObject<USplineMeshComponent>(this, USplineMeshComponent::StaticClass());
-			if(SplineMesh == nullptr)
-			{
-				continue;
-			}
-			// Start of spline
-			if(StartMeshDetails && StartMeshDetails->Mesh && i == 0)
-			{
-				StaticMesh = StartMeshDetails->Mesh;
-				ForwardAxis = StartMeshDetails->ForwardAxis;
-				Material = StartMeshDetails->Material;        
-			}
-			// End of spline
-			else if(EndMeshDetails && EndMeshDetails->Mesh && SplinePointCount > 2 && i == (SplinePointCount - 2))
-			{
-				StaticMesh = EndMeshDetails->Mesh;
-				ForwardAxis = EndMeshDetails->ForwardAxis;
-				Material = EndMeshDetails->Material;
-			}
-			//Middle/Default spline
-			else
+			case ESplineMeshAxis::Y:
+				Rotation = FRotationMatrix::MakeFromY(Direction).Rotator();
+				Scale.Y = Segment.Size() / FMath::Max(MeshBounds.Max.Y - MeshBounds.Min.Y, KINDA_SMALL_NUMBER);
+				MeshStart = MeshBounds.Min.Y * Scale.Y;
+				break;
+			case ESplineMeshAxis::Z:
+				Rotation = FRotationMatrix::MakeFromZ(Direction).Rotator();
+				Scale.Z = Segment.Size() / FMath::Max(MeshBounds.Max.Z - MeshBounds.Min.Z, KINDA_SMALL_NUMBER);
+				MeshStart = MeshBounds.Min.Z * Scale.Z;
+				break;
+			default:
+				Rotation = FRotationMatrix::MakeFromX(Direction).Rotator();
+				Scale.X = Segment.Size() / FMath::Max(MeshBounds.Max.X - MeshBounds.Min.X, KINDA_SMALL_NUMBER);
+				MeshStart = MeshBounds.Min.X * Scale.X;
+				break;
+		}
+
+		InstanceTransforms.FindOrAdd(MeshType).Add(FTransform(Rotation, StartPoint - Direction * MeshStart, Scale));
+	}
+
+	for(const ESplineMeshType MeshType : { ESplineMeshType::Default, ESplineMeshType::Start, ESplineMeshType::End })
+	{
+		const TArray<FTransform>* Transforms = InstanceTransforms.Find(MeshType);
+		UInstancedStaticMeshComponent* InstancedMesh = GetInstancedMesh(MeshType);
+		if(Transforms == nullptr)
+		{
+			if(InstancedMesh && InstancedMesh->GetInstanceCount() > 0)
 			{
-				StaticMesh = DefaultMeshDetails->Mesh;
-				ForwardAxis = DefaultMeshDetails->ForwardAxis;
-				Material = DefaultMeshDetails->Material;
+				InstancedMesh->ClearInstances();
 			}
+			continue;
+		}
 
-			SplineMesh->SetStaticMesh(StaticMesh);
-			SplineMesh->SetForwardAxis(ForwardAxis, true);
-			SplineMesh->SetMaterial(0, Material);
-
-			SplineComponent->SetSplinePointType(i,ESplinePointType::Linear,false);
+		const FSplineMeshDetails* MeshDetails = SplineMeshMap.Find(MeshType);
+		if(InstancedMesh == nullptr)
+		{
+			InstancedMesh = NewObject<UInstancedStaticMeshComponent>(this, UInstancedStaticMeshComponent::StaticClass());
+			InstancedMesh->CreationMethod = EComponentCreationMethod::UserConstructionScript;
+			InstancedMesh->SetMobility(EComponentMobility::Movable);
+			InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			InstancedMesh->SetupAttachment(SplineComponent);
+			InstancedMesh->RegisterComponent();
+			InstancedMeshes.Add(MeshType, InstancedMesh);
+		}
+		InstancedMesh->SetStaticMesh(MeshDetails->Mesh);
+		if(InstancedMesh->GetMaterial(0) != MeshDetails->Material)
+		{
+			InstancedMesh->SetMaterial(0, MeshDetails->Material);
+		}
 
-			SplineComponent->SetTangentsAtSplinePoint(i, FVector::ZeroVector, FVector::ZeroVector, ESplineCoordinateSpace::Local);
+		// keep the instances and only move them, unless the point count changed
+		while(InstancedMesh->GetInstanceCount() > Transforms->Num())
+		{
+			InstancedMesh->RemoveInstance(InstancedMesh->GetInstanceCount() - 1);
+		}
+		const int32 ExistingCount = InstancedMesh->GetInstanceCount();
+		for(int32 Index = ExistingCount; Index < Transforms->Num(); Index++)
+		{
+			InstancedMesh->AddInstance((*Transforms)[Index]);
+		}
+		InstancedMesh->BatchUpdateInstancesTransforms(0, *Transforms, false, true, true);
+	}
+}
 
+USplineMeshComponent* ASplineActor::GetPooledSplineMesh(int32 Index)
+{
+	if(SplineMeshPool.IsValidIndex(Index))
+	{
+		return SplineMeshPool[Index];
+	}
 
-			SplineMesh->RegisterComponent();
-			SplineMesh->CreationMethod = EComponentCreationMethod::UserConstructionScript;
-			SplineMesh->SetMobility(EComponentMobility::Movable);
-			SplineMesh->AttachToComponent(SplineComponent, FAttachmentTransformRules::KeepRelativeTransform);
-			const FVector StartPoint = SplineComponent->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::Type::Local);
-			const FVector StartTangent = SplineComponent->GetTangentAtSplinePoint(i, ESplineCoordinateSpace::Type::Local);
-			const FVector EndPoint = SplineComponent->GetLocationAtSplinePoint(i + 1, ESplineCoordinateSpace::Type::Local);
-			const FVector EndTangent = SplineComponent->GetTangentAtSplinePoint(i + 1, ESplineCoordinateSpace::Type::Local);
-			SplineMesh->SetStartAndEnd(StartPoint, StartTangent, EndPoint, EndTangent, true);
+	USplineMeshComponent* SplineMesh = NewObject<USplineMeshComponent>(this, USplineMeshComponent::StaticClass());
+	if(SplineMesh == nullptr)
+	{
+		return nullptr;
+	}
 
-			
-			SplineMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		}
+	SplineMesh->CreationMethod = EComponentCreationMethod::UserConstructionScript;
+	SplineMesh->SetMobility(EComponentMobility::Movable);
+	SplineMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SplineMesh->SetupAttachment(SplineComponent);
+	SplineMesh->RegisterComponent();
 
-		SplineComponent->UpdateSpline();
-	}
+	SplineMeshPool.Add(SplineMesh);
+	return SplineMesh;
 }
-
@@ -4,6 +4,24 @@
 #include "ShooterTypes.h"
 #include "ShooterCharacter.h"
 
+/** Damage is replicated in steps of 1 / TakeHitInfoDamageScale */
+static const float TakeHitInfoDamageScale = 10.f;
+
+/** Bits packed in front of a replicated FTakeHitInfo */
+namespace ETakeHitInfoFlags
+{
+	enum Type
+	{
+		Killed = 1 << 0,
+		PointDamage = 1 << 1,
+		RadialDamage = 1 << 2,
+		// the plain UDamageType is the most common type, only other types send their class
+		CustomDamageType = 1 << 3,
+	};
+
+	static const uint32 NumBits = 4;
+}
+
 FTakeHitInfo::FTakeHitInfo()
 	: ActualDamage(0)
 	, DamageTypeClass(NULL)
@@ -12,6 +30,9 @@ FTakeHitInfo::FTakeHitInfo()
 	, DamageEventClassID(0)
 	, bKilled(false)
 	, EnsureReplicationByte(0)
+	, RelHitLocation(FVector::ZeroVector)
+	, Momentum(FVector::ZeroVector)
+	, bRelativeHitLocation(false)
 {}
 
 FDamageEvent& FTakeHitInfo::GetDamageEvent()
@@ -41,25 +62,133 @@ FDamageEvent& FTakeHitInfo::GetDamageEvent()
 	}
 }
 
-void FTakeHitInfo::SetDamageEvent(const FDamageEvent& DamageEvent)
+void FTakeHitInfo::SetDamageEvent(const FDamageEvent& DamageEvent, const FVector& HitActorLocation)
 {
 	DamageEventClassID = DamageEvent.GetTypeID();
 	switch (DamageEventClassID)
 	{
 	case FPointDamageEvent::ClassID:
 		PointDamageEvent = *((FPointDamageEvent const*)(&DamageEvent));
+		RelHitLocation = PointDamageEvent.HitInfo.ImpactPoint - HitActorLocation;
+		Momentum = PointDamageEvent.ShotDirection.GetSafeNormal();
 		break;
 	case FRadialDamageEvent::ClassID:
 		RadialDamageEvent = *((FRadialDamageEvent const*)(&DamageEvent));
+		{
+			const FVector HitLocation = RadialDamageEvent.ComponentHits.Num() > 0 ? RadialDamageEvent.ComponentHits[0].ImpactPoint : HitActorLocation;
+			RelHitLocation = HitLocation - HitActorLocation;
+			Momentum = (HitLocation - RadialDamageEvent.Origin).GetSafeNormal();
+		}
 		break;
 	default:
 		GeneralDamageEvent = DamageEvent;
+		RelHitLocation = FVector::ZeroVector;
+		Momentum = FVector::ZeroVector;
 	}
 
 	DamageTypeClass = DamageEvent.DamageTypeClass;
+	bRelativeHitLocation = false;
 }
 
 void FTakeHitInfo::EnsureReplication()
 {
 	EnsureReplicationByte++;
-}
\ No newline at end of file
+}
+
+void FTakeHitInfo::ResolveHitLocation(const FVector& HitActorLocation)
+{
+	if (!bRelativeHitLocation)
+	{
+		return;
+	}
+	bRelativeHitLocation = false;
+
+	// clients only use the events to find the hit location and the direction of the hit, rebuild just that
+	FHitResult Hit;
+	Hit.bBlockingHit = true;
+	Hit.Location = Hit.ImpactPoint = HitActorLocation + RelHitLocation;
+	Hit.Normal = Hit.ImpactNormal = -Momentum;
+
+	switch (DamageEventClassID)
+	{
+	case FPointDamageEvent::ClassID:
+		PointDamageEvent = FPointDamageEvent(ActualDamage, Hit, Momentum, DamageTypeClass);
+		break;
+	case FRadialDamageEvent::ClassID:
+		RadialDamageEvent = FRadialDamageEvent();
+		RadialDamageEvent.DamageTypeClass = DamageTypeClass;
+		RadialDamageEvent.Origin = Hit.ImpactPoint - Momentum;
+		RadialDamageEvent.ComponentHits.Add(Hit);
+		break;
+	default:
+		GeneralDamageEvent.DamageTypeClass = DamageTypeClass;
+	}
+}
+
+bool FTakeHitInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 Flags = 0;
+	if (Ar.IsSaving())
+	{
+		Flags |= bKilled ? ETakeHitInfoFlags::Killed : 0;
+		Flags |= DamageEventClassID == FPointDamageEvent::ClassID ? ETakeHitInfoFlags::PointDamage : 0;
+		Flags |= DamageEventClassID == FRadialDamageEvent::ClassID ? ETakeHitInfoFlags::RadialDamage : 0;
+		Flags |= (DamageTypeClass && DamageTypeClass != UDamageType::StaticClass()) ? ETakeHitInfoFlags::CustomDamageType : 0;
+	}
+	Ar.SerializeBits(&Flags, ETakeHitInfoFlags::NumBits);
+	Ar << EnsureReplicationByte;
+
+	uint32 PackedDamage = Ar.IsSaving() ? (uint32)FMath::Max(FMath::RoundToInt(ActualDamage * TakeHitInfoDamageScale), 0) : 0;
+	Ar.SerializeIntPacked(PackedDamage);
+
+	UObject* DamageTypeObject = DamageTypeClass;
+	if (Flags & ETakeHitInfoFlags::CustomDamageType)
+	{
+		Map->SerializeObject(Ar, UClass::StaticClass(), DamageTypeObject);
+	}
+
+	// instigator and causer may already be gone or not known to the client yet, the hit is still played without them
+	UObject* InstigatorObject = PawnInstigator.Get();
+	Map->SerializeObject(Ar, AShooterCharacter::StaticClass(), InstigatorObject);
+	UObject* CauserObject = DamageCauser.Get();
+	Map->SerializeObject(Ar, AActor::StaticClass(), CauserObject);
+
+	const bool bHasLocation = (Flags & (ETakeHitInfoFlags::PointDamage | ETakeHitInfoFlags::RadialDamage)) != 0;
+	bool bLocationSuccess = true;
+	bool bMomentumSuccess = true;
+	if (bHasLocation)
+	{
+		RelHitLocation.NetSerialize(Ar, Map, bLocationSuccess);
+		Momentum.NetSerialize(Ar, Map, bMomentumSuccess);
+	}
+
+	bOutSuccess = bLocationSuccess && bMomentumSuccess
+		&& (Flags & (ETakeHitInfoFlags::PointDamage | ETakeHitInfoFlags::RadialDamage)) != (ETakeHitInfoFlags::PointDamage | ETakeHitInfoFlags::RadialDamage);
+
+	if (Ar.IsLoading())
+	{
+		bKilled = (Flags & ETakeHitInfoFlags::Killed) != 0;
+		ActualDamage = PackedDamage / TakeHitInfoDamageScale;
+		DamageTypeClass = (Flags & ETakeHitInfoFlags::CustomDamageType) ? Cast<UClass>(DamageTypeObject) : UDamageType::StaticClass();
+		PawnInstigator = Cast<AShooterCharacter>(InstigatorObject);
+		DamageCauser = Cast<AActor>(CauserObject);
+
+		if (Flags & ETakeHitInfoFlags::PointDamage)
+		{
+			DamageEventClassID = FPointDamageEvent::ClassID;
+		}
+		else if (Flags & ETakeHitInfoFlags::RadialDamage)
+		{
+			DamageEventClassID = FRadialDamageEvent::ClassID;
+		}
+		else
+		{
+			DamageEventClassID = FDamageEvent::ClassID;
+			RelHitLocation = FVector::ZeroVector;
+			Momentum = FVector::ZeroVector;
+		}
+		bRelativeHitLocation = true;
+	}
+
+	return true;
+}
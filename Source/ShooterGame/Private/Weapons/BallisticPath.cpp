@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Weapons/BallisticPath.h"
+
+FBallisticPath::FBallisticPath(const FVector& InOrigin, const FVector& InVelocity, float InGravityZ, float InMaxTime, float InSimFrequency)
+	: Origin(InOrigin)
+	, Velocity(InVelocity)
+	, GravityZ(InGravityZ)
+	, MaxTime(FMath::Max(InMaxTime, 0.f))
+	, StepTime(1.f / FMath::Max(InSimFrequency, KINDA_SMALL_NUMBER))
+{
+	NumSteps = FMath::CeilToInt(MaxTime / StepTime - KINDA_SMALL_NUMBER);
+}
+
+FVector FBallisticPath::GetLocation(float Time) const
+{
+	return Origin + Velocity * Time + FVector(0.f, 0.f, 0.5f * GravityZ * Time * Time);
+}
+
+float FBallisticPath::GetStepTime(int32 Step) const
+{
+	return FMath::Min(Step * StepTime, MaxTime);
+}
+
+int32 FBallisticPath::GetStepStride(float Tolerance) const
+{
+	if(FMath::IsNearlyZero(GravityZ))
+	{
+		// a straight line, one chord is exact
+		return FMath::Max(NumSteps, 1);
+	}
+
+	// the arc is furthest from a chord of duration T in its middle, by |GravityZ| * T^2 / 8
+	const float ChordTime = FMath::Sqrt(8.f * FMath::Max(Tolerance, 0.f) / FMath::Abs(GravityZ));
+	return FMath::Max(FMath::FloorToInt(ChordTime / StepTime), 1);
+}
+
+float FBallisticPath::GetChordSag(int32 FirstStep, int32 LastStep) const
+{
+	const float ChordTime = GetStepTime(LastStep) - GetStepTime(FirstStep);
+	return FMath::Abs(GravityZ) * ChordTime * ChordTime / 8.f;
+}
+
+bool FBallisticPath::Sweep(const UWorld* World, int32 Stride, float Radius, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FHitResult& OutHit, int32& OutHitStep) const
+{
+	Stride = FMath::Max(Stride, 1);
+	for(int32 FirstStep = 0; FirstStep < NumSteps; FirstStep += Stride)
+	{
+		const int32 LastStep = FMath::Min(FirstStep + Stride, NumSteps);
+		if(LastStep - FirstStep == 1)
+		{
+			if(SweepSteps(World, FirstStep, LastStep, Radius, TraceChannel, QueryParams, OutHit, OutHitStep))
+			{
+				return true;
+			}
+			continue;
+		}
+
+		// the inflated chord contains the arc, if it is clear the steps inside it are too
+		FHitResult ChordHit;
+		const FCollisionShape ChordShape = FCollisionShape::MakeSphere(Radius + GetChordSag(FirstStep, LastStep));
+		if(World->SweepSingleByChannel(ChordHit, GetLocation(GetStepTime(FirstStep)), GetLocation(GetStepTime(LastStep)), FQuat::Identity, TraceChannel, ChordShape, QueryParams)
+			&& SweepSteps(World, FirstStep, LastStep, Radius, TraceChannel, QueryParams, OutHit, OutHitStep))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FBallisticPath::SweepSteps(const UWorld* World, int32 FirstStep, int32 LastStep, float Radius, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FHitResult& OutHit, int32& OutHitStep) const
+{
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Radius);
+	FVector StepStart = GetLocation(GetStepTime(FirstStep));
+	for(int32 Step = FirstStep; Step < FMath::Min(LastStep, NumSteps); Step++)
+	{
+		const FVector StepEnd = GetLocation(GetStepTime(Step + 1));
+		if(World->SweepSingleByChannel(OutHit, StepStart, StepEnd, FQuat::Identity, TraceChannel, Shape, QueryParams))
+		{
+			OutHitStep = Step;
+			return true;
+		}
+		StepStart = StepEnd;
+	}
+	return false;
+}
+
+void FBallisticPath::GetPoints(int32 EndStep, int32 Stride, TArray<FVector>& OutPoints) const
+{
+	Stride = FMath::Max(Stride, 1);
+	EndStep = FMath::Clamp(EndStep, 0, NumSteps);
+	for(int32 Step = 0; Step < EndStep; Step += Stride)
+	{
+		OutPoints.Add(GetLocation(GetStepTime(Step)));
+	}
+	OutPoints.Add(GetLocation(GetStepTime(EndStep)));
+}
@@ -2,11 +2,56 @@
 
 #include "ShooterGame.h"
 #include "Weapons/ShooterProjectile.h"
+#include "Weapons/ShooterProjectilePool.h"
+#include "Weapons/ShooterProjectileSimulation.h"
 
 #include "LOGHelper.h"
-#include "StatusEffectFactory.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Effects/ShooterExplosionEffect.h"
+#include "Effects/ShooterEffectPool.h"
+
+/** Spawn times are replicated in steps of 1 / SpawnRecordTimeScale seconds */
+static const float SpawnRecordTimeScale = 1000.f;
+
+/** Gravity scales are replicated in steps of 1 / SpawnRecordGravityScale */
+static const float SpawnRecordGravityScale = 100.f;
+
+/** Life times are replicated in steps of 1 / SpawnRecordLifeTimeScale seconds */
+static const float SpawnRecordLifeTimeScale = 100.f;
+
+/** Longest step of the catch up simulation, matches the projectile movement component sub steps */
+static const float SpawnRecordCatchUpStepTime = 0.05f;
+
+bool FProjectileSpawnRecord::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bool bOriginSuccess = true;
+	bool bDirectionSuccess = true;
+	Origin.NetSerialize(Ar, Map, bOriginSuccess);
+	Direction.NetSerialize(Ar, Map, bDirectionSuccess);
+
+	uint32 PackedSpawnTime = Ar.IsSaving() ? (uint32)FMath::Max(FMath::RoundToInt(ServerSpawnTime * SpawnRecordTimeScale), 0) : 0;
+	Ar.SerializeIntPacked(PackedSpawnTime);
+
+	uint32 PackedSpeed = Ar.IsSaving() ? (uint32)FMath::Max(FMath::RoundToInt(Speed), 0) : 0;
+	Ar.SerializeIntPacked(PackedSpeed);
+
+	int16 PackedGravityScale = Ar.IsSaving() ? (int16)FMath::Clamp(FMath::RoundToInt(GravityScale * SpawnRecordGravityScale), (int32)MIN_int16, (int32)MAX_int16) : 0;
+	Ar << PackedGravityScale;
+
+	uint32 PackedLifeTime = Ar.IsSaving() ? (uint32)FMath::Max(FMath::RoundToInt(LifeTime * SpawnRecordLifeTimeScale), 0) : 0;
+	Ar.SerializeIntPacked(PackedLifeTime);
+
+	if (Ar.IsLoading())
+	{
+		ServerSpawnTime = PackedSpawnTime / SpawnRecordTimeScale;
+		Speed = (float)PackedSpeed;
+		GravityScale = PackedGravityScale / SpawnRecordGravityScale;
+		LifeTime = PackedLifeTime / SpawnRecordLifeTimeScale;
+	}
+
+	bOutSuccess = bOriginSuccess && bDirectionSuccess;
+	return true;
+}
 
 AShooterProjectile::AShooterProjectile(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -40,12 +85,30 @@ AShooterProjectile::AShooterProjectile(const FObjectInitializer& ObjectInitializ
 	SetRemoteRoleForBackwardsCompat(ROLE_SimulatedProxy);
 	bReplicates = true;
 	SetReplicatingMovement(true);
+	bUseBatchedSimulation = false;
+	bReplicateSpawnRecord = false;
+	bPredicted = false;
+	PredictionId = 0;
+	PredictionCorrectionTime = 0.25f;
+	ReconcileAlpha = 0.f;
 }
 
 void AShooterProjectile::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 	MovementComp->OnProjectileStop.AddDynamic(this, &AShooterProjectile::OnStopOnImpact);
+	InitProjectileConfig();
+
+	// the flight follows from the spawn record, no need to keep sending it
+	if (bReplicateSpawnRecord)
+	{
+		SetReplicatingMovement(false);
+	}
+}
+
+void AShooterProjectile::InitProjectileConfig()
+{
+	CollisionComp->MoveIgnoreActors.Reset();
 	CollisionComp->MoveIgnoreActors.Add(GetInstigator());
 
 	AShooterWeapon_Projectile* OwnerWeapon = Cast<AShooterWeapon_Projectile>(GetOwner());
@@ -63,12 +126,193 @@ void AShooterProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 	LifeTimeTimer = WeaponConfig.ProjectileLife;
+	RecordSpawn();
+	StartBatchedSimulation();
+}
+
+void AShooterProjectile::RecordSpawn()
+{
+	if (!bReplicateSpawnRecord || bPredicted || GetLocalRole() != ROLE_Authority)
+	{
+		return;
+	}
+
+	SpawnRecord.Origin = GetActorLocation();
+	SpawnRecord.Direction = MovementComp->Velocity.GetSafeNormal();
+	SpawnRecord.ServerSpawnTime = GetWorld()->GetTimeSeconds();
+	SpawnRecord.Speed = MovementComp->Velocity.Size();
+	SpawnRecord.GravityScale = MovementComp->ProjectileGravityScale;
+	SpawnRecord.LifeTime = WeaponConfig.ProjectileLife;
+}
+
+void AShooterProjectile::RecordExplosion(const FVector& Normal)
+{
+	if (bReplicateSpawnRecord)
+	{
+		ExplosionLocation = GetActorLocation();
+		ExplosionNormal = Normal;
+	}
+}
+
+void AShooterProjectile::OnRep_SpawnRecord()
+{
+	// the owner may be known now, it was not when the components were initialized
+	InitProjectileConfig();
+
+	// the flight only depends on the record, the owning weapon may not be relevant to this client
+	MovementComp->InitialSpeed = SpawnRecord.Speed;
+	MovementComp->ProjectileGravityScale = SpawnRecord.GravityScale;
+	WeaponConfig.ProjectileLife = SpawnRecord.LifeTime;
+
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const float ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : SpawnRecord.ServerSpawnTime;
+	float CatchUpTime = FMath::Clamp(ServerTime - SpawnRecord.ServerSpawnTime, 0.f, SpawnRecord.LifeTime);
+	LifeTimeTimer = SpawnRecord.LifeTime - CatchUpTime;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileCatchUp), CollisionComp->bTraceComplexOnMove, this);
+	QueryParams.AddIgnoredActor(GetInstigator());
+	const FCollisionResponseParams Response(CollisionComp->GetCollisionResponseToChannels());
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(CollisionComp->GetScaledSphereRadius());
+
+	// catch up with the server in the steps the movement component would have taken,
+	// stopping at the first blocking hit so the movement component resolves it from there
+	FVector Location = SpawnRecord.Origin;
+	FVector Velocity = SpawnRecord.Direction * SpawnRecord.Speed;
+	while (CatchUpTime > 0.f)
+	{
+		const float StepTime = FMath::Min(CatchUpTime, SpawnRecordCatchUpStepTime);
+		FVector StepEnd = Location;
+		FVector StepVelocity = Velocity;
+		UShooterProjectileSimulation::IntegrateProjectile(StepEnd, StepVelocity, MovementComp->GetGravityZ(), MovementComp->GetMaxSpeed(), StepTime);
+
+		FHitResult Hit;
+		if (GetWorld()->SweepSingleByChannel(Hit, Location, StepEnd, FQuat::Identity, COLLISION_PROJECTILE, Shape, QueryParams, Response))
+		{
+			Location = Hit.Location;
+			break;
+		}
+
+		Location = StepEnd;
+		Velocity = StepVelocity;
+		CatchUpTime -= StepTime;
+	}
+
+	SetActorLocationAndRotation(Location, Velocity.IsNearlyZero() ? GetActorRotation() : Velocity.Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+	MovementComp->SetUpdatedComponent(CollisionComp);
+	MovementComp->Velocity = Velocity;
+}
+
+void AShooterProjectile::StartBatchedSimulation()
+{
+	UShooterProjectileSimulation* ProjectileSimulation = GetWorld()->GetSubsystem<UShooterProjectileSimulation>();
+	if (!bUseBatchedSimulation || bPredicted || GetLocalRole() != ROLE_Authority || ProjectileSimulation == nullptr)
+	{
+		return;
+	}
+
+	// the simulation stops at the first blocking hit, bouncing projectiles keep their movement component
+	if (MovementComp->bShouldBounce)
+	{
+		UE_LOG(LogShooterWeapon, Warning, TEXT("%s uses batched simulation but bounces, it is moved by its movement component instead"), *GetName());
+		return;
+	}
+
+	// the simulation counts down the life time as well, nothing left to tick
+	MovementComp->SetComponentTickEnabled(false);
+	SetActorTickEnabled(false);
+
+	const FCollisionResponseParams Response(CollisionComp->GetCollisionResponseToChannels());
+	ProjectileSimulation->AddProjectile(this, MovementComp->Velocity, MovementComp->GetGravityZ(), MovementComp->GetMaxSpeed(), CollisionComp->GetScaledSphereRadius(), LifeTimeTimer, Response);
+}
+
+void AShooterProjectile::ApplySimulatedMovement(const FVector& NewLocation, const FVector& NewVelocity)
+{
+	const FRotator NewRotation = NewVelocity.IsNearlyZero() ? GetActorRotation() : NewVelocity.Rotation();
+	SetActorLocationAndRotation(NewLocation, NewRotation);
+
+	// replicated movement reads the velocity of the root component
+	MovementComp->Velocity = NewVelocity;
+	CollisionComp->ComponentVelocity = NewVelocity;
 }
 
 void AShooterProjectile::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 	CountDownLife(DeltaSeconds);
+
+	if (bPredicted)
+	{
+		TickReconcile(DeltaSeconds);
+	}
+}
+
+void AShooterProjectile::InitPredictedProjectile(uint8 InPredictionId)
+{
+	bPredicted = true;
+	PredictionId = InPredictionId;
+	SetReplicates(false);
+}
+
+void AShooterProjectile::SetPredictionId(uint8 InPredictionId)
+{
+	PredictionId = InPredictionId;
+}
+
+void AShooterProjectile::OnRep_PredictionId()
+{
+	ClaimPredictedProjectile();
+}
+
+void AShooterProjectile::ClaimPredictedProjectile()
+{
+	AShooterWeapon_Projectile* OwnerWeapon = Cast<AShooterWeapon_Projectile>(GetOwner());
+	if (PredictionId == 0 || bPredicted || OwnerWeapon == nullptr)
+	{
+		return;
+	}
+
+	AShooterProjectile* PredictedProjectile = OwnerWeapon->TakePredictedProjectile(PredictionId);
+	if (PredictedProjectile == nullptr)
+	{
+		return;
+	}
+
+	// a predicted projectile that already stopped has nothing to blend, show the real one right away
+	if (bExploded || PredictedProjectile->IsHidden())
+	{
+		PredictedProjectile->Destroy();
+		return;
+	}
+
+	// keep showing the predicted projectile until it reached this one
+	SetActorHiddenInGame(true);
+	PredictedProjectile->ReconcileTarget = this;
+	PredictedProjectile->ReconcileAlpha = 0.f;
+}
+
+void AShooterProjectile::TickReconcile(float DeltaSeconds)
+{
+	// the replicated projectile is gone while we were blending onto it
+	if (ReconcileTarget.IsStale())
+	{
+		Destroy();
+		return;
+	}
+
+	AShooterProjectile* Target = ReconcileTarget.Get();
+	if (Target == nullptr)
+	{
+		return;
+	}
+
+	ReconcileAlpha = FMath::Min(ReconcileAlpha + DeltaSeconds / FMath::Max(PredictionCorrectionTime, KINDA_SMALL_NUMBER), 1.f);
+	SetActorLocation(FMath::Lerp(GetActorLocation(), Target->GetActorLocation(), ReconcileAlpha));
+
+	if (ReconcileAlpha >= 1.f || Target->HasExploded())
+	{
+		Target->SetActorHiddenInGame(false);
+		Destroy();
+	}
 }
 
 void AShooterProjectile::InitVelocity(FVector& ShootDirection)
@@ -79,10 +323,79 @@ void AShooterProjectile::InitVelocity(FVector& ShootDirection)
 	}
 }
 
+void AShooterProjectile::ReuseProjectile(const FTransform& SpawnTransform, FVector& ShootDirection)
+{
+	SetNetDormancy(DORM_Awake);
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	InitProjectileConfig();
+	bExploded = false;
+	// lets clients reset their copy, even if they never saw it hidden
+	PoolGeneration++;
+	ResetProjectileState();
+	InitVelocity(ShootDirection);
+	RecordSpawn();
+
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+	StartBatchedSimulation();
+	ForceNetUpdate();
+}
+
+void AShooterProjectile::DeactivateProjectile()
+{
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+
+	// the hidden state is still sent before the channel goes dormant
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void AShooterProjectile::ResetProjectileState()
+{
+	LifeTimeTimer = WeaponConfig.ProjectileLife;
+	SetActorEnableCollision(true);
+
+	// stopping on impact detached the movement component from the collision
+	MovementComp->SetUpdatedComponent(CollisionComp);
+
+	if (ParticleComp && ParticleComp->bAutoActivate)
+	{
+		ParticleComp->Activate(true);
+	}
+
+	UAudioComponent* ProjAudioComp = FindComponentByClass<UAudioComponent>();
+	if (ProjAudioComp && ProjAudioComp->bAutoActivate)
+	{
+		ProjAudioComp->Play();
+	}
+}
+
+void AShooterProjectile::ReturnToPool()
+{
+	UShooterProjectilePool* ProjectilePool = GetWorld()->GetSubsystem<UShooterProjectilePool>();
+	if (ProjectilePool)
+	{
+		ProjectilePool->ReleaseProjectile(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
 void AShooterProjectile::OnStopOnImpact(const FHitResult& HitResult)
 {
+	// only the server decides where a projectile explodes, a predicted one waits for the replicated one
+	if (bPredicted)
+	{
+		SetActorHiddenInGame(true);
+		return;
+	}
+
 	if (GetLocalRole() == ROLE_Authority && !bExploded)
 	{
+		RecordExplosion(HitResult.ImpactNormal);
 		Explode(HitResult);
 		DisableAndDestroy();
 	}
@@ -91,14 +404,29 @@ void AShooterProjectile::OnStopOnImpact(const FHitResult& HitResult)
 inline void AShooterProjectile::CountDownLife(float DeltaSeconds)
 {
 	LifeTimeTimer -= DeltaSeconds;
-	if(LifeTimeTimer <= 0 && GetLocalRole() == ROLE_Authority && !bExploded)
+	if(LifeTimeTimer <= 0)
 	{
+		OnLifeTimeEnded();
+	}
+}
+
+void AShooterProjectile::OnLifeTimeEnded()
+{
+	if (bPredicted)
+	{
+		Destroy();
+		return;
+	}
+
+	if(GetLocalRole() == ROLE_Authority && !bExploded)
+	{
+		RecordExplosion(FVector::ZeroVector);
 		Explode(GetActorLocation());
 		DisableAndDestroy();
 	}
 }
 
-AShooterExplosionEffect* const AShooterProjectile::Explosion(const FVector& ExplosionPoint, const FRotator& Rotation)
+void AShooterProjectile::Explosion(const FVector& ExplosionPoint, const FHitResult& SurfaceHit)
 {
 	bExploded = true;
 	
@@ -107,66 +435,124 @@ AShooterExplosionEffect* const AShooterProjectile::Explosion(const FVector& Expl
 		ParticleComp->Deactivate();
 	}
 
-	if (WeaponConfig.ExplosionDamage > 0 && WeaponConfig.ExplosionRadius > 0 && WeaponConfig.DamageType)
+	ResolveExplosion(ExplosionPoint);
+
+	UShooterEffectPool* EffectPool = GetWorld()->GetSubsystem<UShooterEffectPool>();
+	if (ExplosionTemplate && EffectPool)
 	{
-		UGameplayStatics::ApplyRadialDamage(this, WeaponConfig.ExplosionDamage, ExplosionPoint, WeaponConfig.ExplosionRadius, WeaponConfig.DamageType, TArray<AActor*>(), this, MyController.Get());
+		FTransform const SpawnTransform(FRotator{}, ExplosionPoint);
+		EffectPool->SpawnEffect(ExplosionTemplate, SpawnTransform, SurfaceHit);
 	}
+}
 
-	/* Get the overlapping actors in a sphere */
+/** Same check as radial damage does, a blocking hit on another component in between protects VictimComp */
+static bool IsComponentDamageableFrom(UPrimitiveComponent* VictimComp, const FVector& Origin, const AActor* IgnoredActor, FHitResult& OutHitResult)
+{
+	const FCollisionQueryParams LineParams(SCENE_QUERY_STAT(ExplosionVisibility), true, IgnoredActor);
+	const FVector TraceEnd = VictimComp->Bounds.Origin;
+	FVector TraceStart = Origin;
+	if (Origin == TraceEnd)
+	{
+		// tiny nudge so the trace isn't zero length
+		TraceStart.Z += 0.01f;
+	}
+
+	if (VictimComp->GetWorld()->LineTraceSingleByChannel(OutHitResult, TraceStart, TraceEnd, ECC_Visibility, LineParams))
+	{
+		return OutHitResult.Component == VictimComp;
+	}
+
+	// nothing in between, damage the component from its location
+	const FVector FakeHitLocation = VictimComp->GetComponentLocation();
+	OutHitResult = FHitResult(VictimComp->GetOwner(), VictimComp, FakeHitLocation, (Origin - FakeHitLocation).GetSafeNormal());
+	return true;
+}
+
+void AShooterProjectile::ResolveExplosion(const FVector& ExplosionPoint)
+{
+	const bool bApplyDamage = WeaponConfig.ExplosionDamage > 0 && WeaponConfig.DamageType;
+
+	/* Status effects run on the server only, clients get their results replicated */
+	AShooterCharacter* OwnerCharacter = nullptr;
+	if (GetLocalRole() == ROLE_Authority && MyController.IsValid())
+	{
+		OwnerCharacter = Cast<AShooterCharacter>(MyController->GetCharacter());
+	}
+	const bool bApplyEffects = OwnerCharacter && StatusEffects.Num() > 0;
+
+	if (WeaponConfig.ExplosionRadius <= 0 || (!bApplyDamage && !bApplyEffects))
+	{
+		return;
+	}
+
+	/* One overlap gives the candidates for both damage and status effects */
 	TArray<FOverlapResult> Overlaps;
-	/* Make sure to hit the same character only once */
-	TSet<AShooterCharacter*> HitShooterCharacters;
-	if (GetWorld() && MyController.IsValid() && MyController->GetCharacter())
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileExplosion), false, this);
+	GetWorld()->OverlapMultiByObjectType(Overlaps, ExplosionPoint, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects), FCollisionShape::MakeSphere(WeaponConfig.ExplosionRadius), QueryParams);
+
+	/* Group the damageable components by actor, so each actor is handled once */
+	TMap<AActor*, TArray<FHitResult>, TInlineSetAllocator<16>> HitActors;
+	for (const FOverlapResult& Overlap : Overlaps)
 	{
-		GetWorld()->OverlapMultiByObjectType(Overlaps, ExplosionPoint, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects), FCollisionShape::MakeSphere(WeaponConfig.ExplosionRadius));
-		AShooterCharacter* OwnerCharacter = Cast<AShooterCharacter>(MyController->GetCharacter());
-		for (auto OverlapResult : Overlaps)
+		AActor* const OverlapActor = Overlap.GetActor();
+		UPrimitiveComponent* const OverlapComponent = Overlap.GetComponent();
+		if (OverlapActor == nullptr || OverlapComponent == nullptr)
 		{
-			if(OverlapResult.GetActor())
+			continue;
+		}
+
+		TArray<FHitResult>& ComponentHits = HitActors.FindOrAdd(OverlapActor);
+		FHitResult Hit;
+		if (bApplyDamage && OverlapActor->CanBeDamaged() && IsComponentDamageableFrom(OverlapComponent, ExplosionPoint, this, Hit))
+		{
+			ComponentHits.Add(Hit);
+		}
+	}
+
+	if (bApplyDamage)
+	{
+		/* Damage falls off linearly to zero at the explosion radius */
+		FRadialDamageEvent DamageEvent;
+		DamageEvent.DamageTypeClass = WeaponConfig.DamageType;
+		DamageEvent.Origin = ExplosionPoint;
+		DamageEvent.Params = FRadialDamageParams(WeaponConfig.ExplosionDamage, 0.f, 0.f, WeaponConfig.ExplosionRadius, 1.f);
+
+		for (TPair<AActor*, TArray<FHitResult>>& HitActor : HitActors)
+		{
+			if (HitActor.Value.Num() > 0 && IsValid(HitActor.Key))
 			{
-				AShooterCharacter* TargetCharacter = Cast<AShooterCharacter>(OverlapResult.GetActor());
-				if(TargetCharacter &&  !HitShooterCharacters.Contains(TargetCharacter))
-				{
-					HitShooterCharacters.Add(TargetCharacter);
-					for (auto Effect : StatusEffects)
-					{
-						TargetCharacter->ApplyStatusEffect(StatusEffectFactory::CreateEffect(Effect, OwnerCharacter, TargetCharacter));
-					}
-				}
+				DamageEvent.ComponentHits = MoveTemp(HitActor.Value);
+				HitActor.Key->TakeDamage(WeaponConfig.ExplosionDamage, DamageEvent, MyController.Get(), this);
 			}
 		}
 	}
 
-	if (ExplosionTemplate)
+	if (bApplyEffects)
 	{
-		FTransform const SpawnTransform(Rotation, ExplosionPoint);
-		AShooterExplosionEffect* const EffectActor = GetWorld()->SpawnActorDeferred<AShooterExplosionEffect>(ExplosionTemplate, SpawnTransform);
-		return EffectActor;
+		for (const TPair<AActor*, TArray<FHitResult>>& HitActor : HitActors)
+		{
+			AShooterCharacter* TargetCharacter = IsValid(HitActor.Key) ? Cast<AShooterCharacter>(HitActor.Key) : nullptr;
+			if (TargetCharacter)
+			{
+				for (const FStatusEffectData& Effect : StatusEffects)
+				{
+					TargetCharacter->ApplyStatusEffect(Effect, OwnerCharacter);
+				}
+			}
+		}
 	}
-	return nullptr;
 }
 
 void AShooterProjectile::Explode(const FHitResult& Impact)
 {
 	// effects and damage origin shouldn't be placed inside mesh at impact point
 	const FVector NudgedImpactLocation = Impact.ImpactPoint + Impact.ImpactNormal * 10.0f;
-	AShooterExplosionEffect* const EffectActor = Explosion(NudgedImpactLocation, Impact.ImpactNormal.Rotation());
-	if(EffectActor)
-	{
-		EffectActor->SurfaceHit = Impact;
-		FTransform const SpawnTransform(FRotator{}, NudgedImpactLocation);
-		UGameplayStatics::FinishSpawningActor(EffectActor, SpawnTransform);
-	}
+	Explosion(NudgedImpactLocation, Impact);
 }
 
 void AShooterProjectile::Explode(const FVector& ExplosionPoint)
 {
-	AShooterExplosionEffect* const EffectActor = Explosion(ExplosionPoint, FRotator{});
-	if(EffectActor)
-	{
-		FTransform const SpawnTransform(FRotator{}, ExplosionPoint);
-		UGameplayStatics::FinishSpawningActor(EffectActor, SpawnTransform);
-	}
+	Explosion(ExplosionPoint, FHitResult());
 }
 
 void AShooterProjectile::DisableAndDestroy()
@@ -178,15 +564,45 @@ void AShooterProjectile::DisableAndDestroy()
 	}
 
 	MovementComp->StopMovementImmediately();
+	SetActorEnableCollision(false);
+
+	UShooterProjectileSimulation* ProjectileSimulation = GetWorld()->GetSubsystem<UShooterProjectileSimulation>();
+	if (ProjectileSimulation)
+	{
+		ProjectileSimulation->RemoveProjectile(this);
+	}
 
 	// give clients some time to show explosion
-	SetLifeSpan( 2.0f );
+	if (GetLocalRole() == ROLE_Authority && GetWorld()->GetSubsystem<UShooterProjectilePool>())
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_ReturnToPool, this, &AShooterProjectile::ReturnToPool, 2.0f, false);
+	}
+	else
+	{
+		SetLifeSpan( 2.0f );
+	}
 }
 
 ///CODE_SNIPPET_START: AActor::GetActorLocation AActor::GetActorRotation
 void AShooterProjectile::OnRep_Exploded()
 {
+	// a reused projectile is not exploded anymore
+	if (!bExploded)
+	{
+		return;
+	}
+	SetActorEnableCollision(false);
+
+	// without replicated movement our own flight may be off, explode where the server did
 	FVector ProjDirection = GetActorForwardVector();
+	if (bReplicateSpawnRecord)
+	{
+		SetActorLocation(ExplosionLocation);
+		if (!ExplosionNormal.IsZero())
+		{
+			ProjDirection = -ExplosionNormal;
+		}
+	}
 
 	const FVector StartTrace = GetActorLocation() - ProjDirection * 200;
 	const FVector EndTrace = GetActorLocation() + ProjDirection * 150;
@@ -203,6 +619,25 @@ void AShooterProjectile::OnRep_Exploded()
 }
 ///CODE_SNIPPET_END
 
+void AShooterProjectile::OnRep_PoolGeneration()
+{
+	InitProjectileConfig();
+	ResetProjectileState();
+	ClaimPredictedProjectile();
+
+	// the reset may have come in after the new spawn record
+	if (bReplicateSpawnRecord && !IsHidden())
+	{
+		OnRep_SpawnRecord();
+	}
+
+	// first seen while waiting in the pool
+	if (IsHidden())
+	{
+		SetActorEnableCollision(false);
+	}
+}
+
 void AShooterProjectile::PostNetReceiveVelocity(const FVector& NewVelocity)
 {
 	if (MovementComp)
@@ -216,4 +651,9 @@ void AShooterProjectile::GetLifetimeReplicatedProps( TArray< FLifetimeProperty >
 	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
 	
 	DOREPLIFETIME( AShooterProjectile, bExploded );
+	DOREPLIFETIME( AShooterProjectile, PoolGeneration );
+	DOREPLIFETIME_CONDITION( AShooterProjectile, PredictionId, COND_OwnerOnly );
+	DOREPLIFETIME( AShooterProjectile, SpawnRecord );
+	DOREPLIFETIME( AShooterProjectile, ExplosionLocation );
+	DOREPLIFETIME( AShooterProjectile, ExplosionNormal );
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterProjectilePool.h"
+#include "Weapons/ShooterProjectile.h"
+
+bool UShooterProjectilePool::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterProjectilePool::Deinitialize()
+{
+	Pools.Reset();
+	Super::Deinitialize();
+}
+
+AShooterProjectile* UShooterProjectilePool::FireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, FVector ShootDirection, AActor* ProjectileOwner, APawn* ProjectileInstigator)
+{
+	if (ProjectileClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	FShooterProjectilePoolList* Pool = Pools.Find(ProjectileClass);
+	while (Pool && Pool->Projectiles.Num() > 0)
+	{
+		AShooterProjectile* Projectile = Pool->Projectiles.Pop(false);
+		// pooled projectiles can still be destroyed with their level
+		if (IsValid(Projectile))
+		{
+			Projectile->SetInstigator(ProjectileInstigator);
+			Projectile->SetOwner(ProjectileOwner);
+			Projectile->ReuseProjectile(SpawnTransform, ShootDirection);
+			return Projectile;
+		}
+	}
+
+	AShooterProjectile* Projectile = Cast<AShooterProjectile>(UGameplayStatics::BeginDeferredActorSpawnFromClass(this, ProjectileClass, SpawnTransform));
+	if (Projectile)
+	{
+		Projectile->SetInstigator(ProjectileInstigator);
+		Projectile->SetOwner(ProjectileOwner);
+		Projectile->InitVelocity(ShootDirection);
+
+		UGameplayStatics::FinishSpawningActor(Projectile, SpawnTransform);
+	}
+	return Projectile;
+}
+
+void UShooterProjectilePool::ReleaseProjectile(AShooterProjectile* Projectile)
+{
+	if (!IsValid(Projectile))
+	{
+		return;
+	}
+
+	FShooterProjectilePoolList& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	if (Pool.Projectiles.Num() >= MaxPooledProjectiles)
+	{
+		Projectile->Destroy();
+		return;
+	}
+
+	Projectile->DeactivateProjectile();
+	Pool.Projectiles.Add(Projectile);
+}
@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Weapons/ShooterProjectileSimulation.h"
+#include "Weapons/ShooterProjectile.h"
+
+/** Longest step a projectile is moved by at once, matches the projectile movement component sub steps */
+static const float ProjectileSimulationMaxStepTime = 0.05f;
+
+/** Max number of steps in one frame, a longer frame is split evenly into longer steps */
+static const int32 ProjectileSimulationMaxSteps = 8;
+
+void FProjectileSimulationStorage::RemoveAtSwap(int32 Index)
+{
+	Projectiles.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	GravityZs.RemoveAtSwap(Index, 1, false);
+	MaxSpeeds.RemoveAtSwap(Index, 1, false);
+	Radii.RemoveAtSwap(Index, 1, false);
+	LifeTimes.RemoveAtSwap(Index, 1, false);
+	Responses.RemoveAtSwap(Index, 1, false);
+}
+
+void FProjectileSimulationStorage::Reset()
+{
+	Projectiles.Reset();
+	Locations.Reset();
+	Velocities.Reset();
+	GravityZs.Reset();
+	MaxSpeeds.Reset();
+	Radii.Reset();
+	LifeTimes.Reset();
+	Responses.Reset();
+}
+
+bool UShooterProjectileSimulation::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UShooterProjectileSimulation::Deinitialize()
+{
+	Storage.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UShooterProjectileSimulation::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UShooterProjectileSimulation::IsTickable() const
+{
+	return Storage.Num() > 0;
+}
+
+TStatId UShooterProjectileSimulation::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UShooterProjectileSimulation, STATGROUP_Tickables);
+}
+
+void UShooterProjectileSimulation::AddProjectile(AShooterProjectile* Projectile, const FVector& Velocity, float GravityZ, float MaxSpeed, float Radius, float LifeTime, const FCollisionResponseParams& Response)
+{
+	if (Projectile == nullptr)
+	{
+		return;
+	}
+
+	RemoveProjectile(Projectile);
+
+	Storage.Projectiles.Add(Projectile);
+	Storage.Locations.Add(Projectile->GetActorLocation());
+	Storage.Velocities.Add(Velocity);
+	Storage.GravityZs.Add(GravityZ);
+	Storage.MaxSpeeds.Add(MaxSpeed);
+	Storage.Radii.Add(Radius);
+	Storage.LifeTimes.Add(LifeTime);
+	Storage.Responses.Add(Response);
+}
+
+void UShooterProjectileSimulation::RemoveProjectile(AShooterProjectile* Projectile)
+{
+	const int32 Index = Storage.Projectiles.IndexOfByKey(Projectile);
+	if (Index != INDEX_NONE)
+	{
+		Storage.RemoveAtSwap(Index);
+	}
+}
+
+void UShooterProjectileSimulation::Tick(float DeltaTime)
+{
+	TArray<TPair<TWeakObjectPtr<AShooterProjectile>, FHitResult>> Impacts;
+	TArray<TWeakObjectPtr<AShooterProjectile>> Expired;
+
+	const int32 NumSteps = FMath::Clamp(FMath::CeilToInt(DeltaTime / ProjectileSimulationMaxStepTime), 1, ProjectileSimulationMaxSteps);
+	for (int32 Step = 0; Step < NumSteps; Step++)
+	{
+		StepProjectiles(DeltaTime / NumSteps, Impacts, Expired);
+	}
+
+	// the actors only need to be moved once, to where the last step left them
+	for (int32 Index = 0; Index < Storage.Num(); Index++)
+	{
+		if (AShooterProjectile* Projectile = Storage.Projectiles[Index].Get())
+		{
+			Projectile->ApplySimulatedMovement(Storage.Locations[Index], Storage.Velocities[Index]);
+		}
+	}
+
+	// projectiles are done moving, let them explode now that the storage is not iterated anymore
+	for (const TPair<TWeakObjectPtr<AShooterProjectile>, FHitResult>& Impact : Impacts)
+	{
+		if (AShooterProjectile* Projectile = Impact.Key.Get())
+		{
+			Projectile->OnStopOnImpact(Impact.Value);
+		}
+	}
+	for (const TWeakObjectPtr<AShooterProjectile>& ExpiredProjectile : Expired)
+	{
+		if (AShooterProjectile* Projectile = ExpiredProjectile.Get())
+		{
+			Projectile->OnLifeTimeEnded();
+		}
+	}
+}
+
+void UShooterProjectileSimulation::IntegrateProjectile(FVector& Location, FVector& Velocity, float GravityZ, float MaxSpeed, float DeltaTime)
+{
+	// same integration as the projectile movement component
+	const FVector Acceleration(0.f, 0.f, GravityZ);
+	Location += Velocity * DeltaTime + Acceleration * (0.5f * DeltaTime * DeltaTime);
+	Velocity += Acceleration * DeltaTime;
+	if (MaxSpeed > 0.f)
+	{
+		Velocity = Velocity.GetClampedToMaxSize(MaxSpeed);
+	}
+}
+
+void UShooterProjectileSimulation::StepProjectiles(float DeltaTime, TArray<TPair<TWeakObjectPtr<AShooterProjectile>, FHitResult>>& OutImpacts, TArray<TWeakObjectPtr<AShooterProjectile>>& OutExpired)
+{
+	UWorld* World = GetWorld();
+
+	// walk backwards so removed projectiles can be swapped with already moved ones
+	for (int32 Index = Storage.Num() - 1; Index >= 0; Index--)
+	{
+		AShooterProjectile* Projectile = Storage.Projectiles[Index].Get();
+		if (Projectile == nullptr)
+		{
+			Storage.RemoveAtSwap(Index);
+			continue;
+		}
+
+		const FVector Start = Storage.Locations[Index];
+		FVector End = Start;
+		FVector NewVelocity = Storage.Velocities[Index];
+		IntegrateProjectile(End, NewVelocity, Storage.GravityZs[Index], Storage.MaxSpeeds[Index], DeltaTime);
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSimulation), Projectile->GetCollisionComp()->bTraceComplexOnMove, Projectile);
+		QueryParams.AddIgnoredActor(Projectile->GetInstigator());
+
+		FHitResult Hit;
+		if (World->SweepSingleByChannel(Hit, Start, End, FQuat::Identity, COLLISION_PROJECTILE, FCollisionShape::MakeSphere(Storage.Radii[Index]), QueryParams, Storage.Responses[Index]))
+		{
+			Projectile->ApplySimulatedMovement(Hit.Location, FVector::ZeroVector);
+			OutImpacts.Emplace(Projectile, Hit);
+			Storage.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Storage.Locations[Index] = End;
+		Storage.Velocities[Index] = NewVelocity;
+
+		Storage.LifeTimes[Index] -= DeltaTime;
+		if (Storage.LifeTimes[Index] <= 0.f)
+		{
+			Projectile->ApplySimulatedMovement(End, NewVelocity);
+			OutExpired.Add(Projectile);
+			Storage.RemoveAtSwap(Index);
+		}
+	}
+}
@@ -4,6 +4,31 @@
 #include "Weapons/ShooterWeapon_Instant.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Effects/ShooterImpactEffect.h"
+#include "Effects/ShooterEffectPool.h"
+#include "Player/ShooterLagCompensation.h"
+
+static int32 PelletAsyncTraces = 1;
+FAutoConsoleVariableRef CVarPelletAsyncTraces(
+	TEXT("p.PelletAsyncTraces"),
+	PelletAsyncTraces,
+	TEXT("Trace the pellets of a shot with async traces, the shot is processed in the next frame\n")
+	TEXT("0: Sync, 1: Async"),
+	ECVF_Default);
+
+/** Reduce a hit to the data the server needs to verify it */
+static FInstantHitBatchEntry MakeHitBatchEntry(const FHitResult& Impact, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread)
+{
+	FInstantHitBatchEntry Hit;
+	Hit.HitActor = Impact.GetActor();
+	Hit.ImpactPoint = Impact.ImpactPoint;
+	Hit.ImpactNormal = Impact.ImpactNormal;
+	Hit.ShootDir = ShootDir;
+	Hit.RandomSeed = RandomSeed;
+	Hit.ReticleSpread = (uint16)FMath::Clamp(FMath::RoundToInt(ReticleSpread * 100.0f), 0, (int32)MAX_uint16);
+	Hit.BoneName = Impact.BoneName;
+	Hit.PhysMaterial = Impact.PhysMaterial;
+	return Hit;
+}
 
 AShooterWeapon_Instant::AShooterWeapon_Instant(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -16,17 +41,25 @@ AShooterWeapon_Instant::AShooterWeapon_Instant(const FObjectInitializer& ObjectI
 void AShooterWeapon_Instant::FireWeapon()
 {
 	const int32 RandomSeed = FMath::Rand();
-	FRandomStream WeaponRandomStream(RandomSeed);
 	const float CurrentSpread = GetCurrentSpread();
-	const float ConeHalfAngle = FMath::DegreesToRadians(CurrentSpread * 0.5f);
 
 	const FVector AimDir = GetAdjustedAim();
 	const FVector StartTrace = GetCameraDamageStartLocation(AimDir);
-	const FVector ShootDir = WeaponRandomStream.VRandCone(AimDir, ConeHalfAngle, ConeHalfAngle);
-	const FVector EndTrace = StartTrace + ShootDir * InstantConfig.WeaponRange;
 
-	const FHitResult Impact = WeaponTrace(StartTrace, EndTrace);
-	ProcessInstantHit(Impact, StartTrace, ShootDir, RandomSeed, CurrentSpread);
+	if (InstantConfig.PelletCount > 1)
+	{
+		FirePellets(StartTrace, AimDir, RandomSeed, CurrentSpread, false);
+	}
+	else
+	{
+		FRandomStream WeaponRandomStream(RandomSeed);
+		const float ConeHalfAngle = FMath::DegreesToRadians(CurrentSpread * 0.5f);
+		const FVector ShootDir = WeaponRandomStream.VRandCone(AimDir, ConeHalfAngle, ConeHalfAngle);
+		const FVector EndTrace = StartTrace + ShootDir * InstantConfig.WeaponRange;
+
+		const FHitResult Impact = WeaponTrace(StartTrace, EndTrace);
+		ProcessInstantHit(Impact, StartTrace, ShootDir, RandomSeed, CurrentSpread);
+	}
 
 	CurrentFiringSpread = FMath::Min(InstantConfig.FiringSpreadMax, CurrentFiringSpread + InstantConfig.FiringSpreadIncrement);
 }
@@ -38,7 +71,42 @@ bool AShooterWeapon_Instant::ServerNotifyHit_Validate(const FHitResult& Impact,
 
 void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Impact, FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread)
 {
-	const float WeaponAngleDot = FMath::Abs(FMath::Sin(ReticleSpread * PI / 180.f));
+	VerifyClientHit(Impact, ShootDir, RandomSeed, ReticleSpread, CurrentState != EWeaponState::Idle, 0.0f);
+}
+
+bool AShooterWeapon_Instant::ServerNotifyHits_Validate(const TArray<FInstantHitBatchEntry>& Hits)
+{
+	return true;
+}
+
+void AShooterWeapon_Instant::ServerNotifyHits_Implementation(const TArray<FInstantHitBatchEntry>& Hits)
+{
+	// the last batch of a burst is sent after the client stopped firing, accept it for as long as it could have been held back
+	const float BatchFireTime = LastFireTime + WeaponConfig.TimeBetweenShots + InstantConfig.HitNotifyBatchTime;
+	const bool bWasFiring = CurrentState != EWeaponState::Idle || BatchFireTime >= GetWorld()->GetTimeSeconds();
+
+	// a client never sends more than a full batch or the pellets of one shot, ignore the rest instead of dropping the connection
+	const int32 NumHits = FMath::Min(Hits.Num(), FMath::Max3(InstantConfig.HitNotifyBatchSize, InstantConfig.PelletCount, 1));
+	for (int32 HitIndex = 0; HitIndex < NumHits; HitIndex++)
+	{
+		const FInstantHitBatchEntry& Hit = Hits[HitIndex];
+
+		// the constructor leaves the hit non blocking, rebuild it as the trace the client made
+		FHitResult Impact(Hit.HitActor, nullptr, Hit.ImpactPoint, Hit.ImpactNormal);
+		Impact.bBlockingHit = true;
+		Impact.TraceStart = GetCameraDamageStartLocation(Hit.ShootDir);
+		Impact.TraceEnd = Hit.ImpactPoint;
+		Impact.BoneName = Hit.BoneName;
+		Impact.PhysMaterial = Hit.PhysMaterial;
+		VerifyClientHit(Impact, Hit.ShootDir, Hit.RandomSeed, Hit.ReticleSpread * 0.01f, bWasFiring, Hit.ShotAge * 0.001f);
+	}
+}
+
+void AShooterWeapon_Instant::VerifyClientHit(const FHitResult& Impact, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread, bool bWasFiring, float ShotAge)
+{
+	// pellets can go further off the view than the reticle spread
+	const float PelletSpread = InstantConfig.PelletCount > 1 ? InstantConfig.PelletSpread : 0.0f;
+	const float WeaponAngleDot = FMath::Abs(FMath::Sin((ReticleSpread + PelletSpread) * PI / 180.f));
 
 	// if we have an instigator, calculate dot between the view and the shot
 	if (GetInstigator() && (Impact.GetActor() || Impact.bBlockingHit))
@@ -50,7 +118,7 @@ void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Im
 		const float ViewDotHitDir = FVector::DotProduct(GetInstigator()->GetViewRotation().Vector(), ViewDir);
 		if (ViewDotHitDir > InstantConfig.AllowedViewDotHitDir - WeaponAngleDot)
 		{
-			if (CurrentState != EWeaponState::Idle)
+			if (bWasFiring)
 			{
 				if (Impact.GetActor() == NULL)
 				{
@@ -67,17 +135,29 @@ void AShooterWeapon_Instant::ServerNotifyHit_Implementation(const FHitResult& Im
 				}
 				else
 				{
-					// Get the component bounding box
-					const FBox HitBox = Impact.GetActor()->GetComponentsBoundingBox();
+					// Get the bounding box at the time the client shot, characters keep a history of it on the server
+					FBox HitBox = Impact.GetActor()->GetComponentsBoundingBox();
+					const AShooterCharacter* HitCharacter = Cast<AShooterCharacter>(Impact.GetActor());
+					UShooterLagCompensation* LagCompensation = GetWorld()->GetSubsystem<UShooterLagCompensation>();
+					const bool bRewound = HitCharacter && LagCompensation
+						&& LagCompensation->GetHitBoxAt(HitCharacter, LagCompensation->GetClientTime(GetInstigator()) - ShotAge, HitBox);
 
-					// calculate the box extent, and increase by a leeway
 					FVector BoxExtent = 0.5 * (HitBox.Max - HitBox.Min);
-					BoxExtent *= InstantConfig.ClientSideHitLeeway;
+					if (bRewound)
+					{
+						// the rewound box is where the client saw the character, only allow for the error of the ping estimate
+						BoxExtent += FVector(InstantConfig.RewoundHitTolerance);
+					}
+					else
+					{
+						// calculate the box extent, and increase by a leeway
+						BoxExtent *= InstantConfig.ClientSideHitLeeway;
 
-					// avoid precision errors with really thin objects
-					BoxExtent.X = FMath::Max(20.0f, BoxExtent.X);
-					BoxExtent.Y = FMath::Max(20.0f, BoxExtent.Y);
-					BoxExtent.Z = FMath::Max(20.0f, BoxExtent.Z);
+						// avoid precision errors with really thin objects
+						BoxExtent.X = FMath::Max(20.0f, BoxExtent.X);
+						BoxExtent.Y = FMath::Max(20.0f, BoxExtent.Y);
+						BoxExtent.Z = FMath::Max(20.0f, BoxExtent.Z);
+					}
 
 					// Get the box center
 					const FVector BoxCenter = (HitBox.Min + HitBox.Max) * 0.5;
@@ -129,6 +209,135 @@ void AShooterWeapon_Instant::ServerNotifyMiss_Implementation(FVector_NetQuantize
 	}
 }
 
+void AShooterWeapon_Instant::GetPelletDirections(const FVector& AimDir, int32 RandomSeed, float ReticleSpread, TArray<FVector, TInlineAllocator<16>>& OutShootDirs) const
+{
+	FRandomStream WeaponRandomStream(RandomSeed);
+	const float ConeHalfAngle = FMath::DegreesToRadians(ReticleSpread * 0.5f);
+	const float PelletHalfAngle = FMath::DegreesToRadians(InstantConfig.PelletSpread * 0.5f);
+
+	// the shot is spread like a single bullet, its pellets are spread around it
+	const FVector ShotDir = WeaponRandomStream.VRandCone(AimDir, ConeHalfAngle, ConeHalfAngle);
+	OutShootDirs.Reset(InstantConfig.PelletCount);
+	for (int32 Pellet = 0; Pellet < InstantConfig.PelletCount; Pellet++)
+	{
+		OutShootDirs.Add(WeaponRandomStream.VRandCone(ShotDir, PelletHalfAngle, PelletHalfAngle));
+	}
+}
+
+void AShooterWeapon_Instant::FirePellets(const FVector& Origin, const FVector& AimDir, int32 RandomSeed, float ReticleSpread, bool bSimulated)
+{
+	FInstantPelletShot Shot;
+	Shot.Origin = Origin;
+	Shot.RandomSeed = RandomSeed;
+	Shot.ReticleSpread = ReticleSpread;
+	Shot.bSimulated = bSimulated;
+	GetPelletDirections(AimDir, RandomSeed, ReticleSpread, Shot.ShootDirs);
+
+	if (PelletAsyncTraces == 0)
+	{
+		for (const FVector& ShootDir : Shot.ShootDirs)
+		{
+			Shot.Impacts.Add(WeaponTrace(Origin, Origin + ShootDir * InstantConfig.WeaponRange));
+		}
+		Shot.NumPending = 0;
+		ProcessPelletHits(Shot);
+		return;
+	}
+
+	// same query as WeaponTrace, all pellets are traced together with the other async traces of the frame
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(PelletTrace), true, GetInstigator());
+	TraceParams.bReturnPhysicalMaterial = true;
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &AShooterWeapon_Instant::OnPelletTraceDone);
+
+	for (const FVector& ShootDir : Shot.ShootDirs)
+	{
+		Shot.TraceHandles.Add(GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Origin, Origin + ShootDir * InstantConfig.WeaponRange, COLLISION_WEAPON, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate));
+	}
+	Shot.Impacts.SetNum(Shot.ShootDirs.Num());
+	Shot.NumPending = Shot.ShootDirs.Num();
+	PendingPelletShots.Add(MoveTemp(Shot));
+}
+
+void AShooterWeapon_Instant::OnPelletTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceData)
+{
+	for (int32 ShotIndex = 0; ShotIndex < PendingPelletShots.Num(); ShotIndex++)
+	{
+		FInstantPelletShot& Shot = PendingPelletShots[ShotIndex];
+		const int32 Pellet = Shot.TraceHandles.IndexOfByKey(TraceHandle);
+		if (Pellet == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FHitResult* Impact = FHitResult::GetFirstBlockingHit(TraceData.OutHits);
+		if (Impact)
+		{
+			Shot.Impacts[Pellet] = *Impact;
+		}
+
+		if (--Shot.NumPending == 0)
+		{
+			const FInstantPelletShot DoneShot = MoveTemp(Shot);
+			PendingPelletShots.RemoveAt(ShotIndex);
+			ProcessPelletHits(DoneShot);
+		}
+		return;
+	}
+}
+
+void AShooterWeapon_Instant::ProcessPelletHits(const FInstantPelletShot& Shot)
+{
+	if (Shot.bSimulated)
+	{
+		for (int32 Pellet = 0; Pellet < Shot.Impacts.Num(); Pellet++)
+		{
+			const FHitResult& Impact = Shot.Impacts[Pellet];
+			if (Impact.bBlockingHit)
+			{
+				SpawnImpactEffects(Impact);
+				SpawnTrailEffect(Impact.ImpactPoint);
+			}
+			else
+			{
+				SpawnTrailEffect(Shot.Origin + Shot.ShootDirs[Pellet] * InstantConfig.WeaponRange);
+			}
+		}
+		return;
+	}
+
+	// same rules as ProcessInstantHit, but all pellet hits go to the server in one notify
+	const bool bNotifyServer = MyPawn && MyPawn->IsLocallyControlled() && GetNetMode() == NM_Client;
+	TArray<FInstantHitBatchEntry> Notifies;
+	int32 MissedPellet = INDEX_NONE;
+	for (int32 Pellet = 0; Pellet < Shot.Impacts.Num(); Pellet++)
+	{
+		const FHitResult& Impact = Shot.Impacts[Pellet];
+		if (bNotifyServer)
+		{
+			if (Impact.GetActor() ? Impact.GetActor()->GetRemoteRole() == ROLE_Authority : Impact.bBlockingHit)
+			{
+				Notifies.Add(MakeHitBatchEntry(Impact, Shot.ShootDirs[Pellet], Shot.RandomSeed, Shot.ReticleSpread));
+			}
+			else if (Impact.GetActor() == NULL)
+			{
+				MissedPellet = Pellet;
+			}
+		}
+
+		ProcessInstantHit_Confirmed(Impact, Shot.Origin, Shot.ShootDirs[Pellet], Shot.RandomSeed, Shot.ReticleSpread);
+	}
+
+	if (Notifies.Num() > 0)
+	{
+		ServerNotifyHits(Notifies);
+	}
+	else if (MissedPellet != INDEX_NONE)
+	{
+		// remote clients simulate every pellet from the seed, one unreliable miss is enough to replicate the shot
+		ServerNotifyMiss(Shot.ShootDirs[MissedPellet], Shot.RandomSeed, Shot.ReticleSpread);
+	}
+}
+
 void AShooterWeapon_Instant::ProcessInstantHit(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread)
 {
 	if (MyPawn && MyPawn->IsLocallyControlled() && GetNetMode() == NM_Client)
@@ -137,14 +346,14 @@ void AShooterWeapon_Instant::ProcessInstantHit(const FHitResult& Impact, const F
 		if (Impact.GetActor() && Impact.GetActor()->GetRemoteRole() == ROLE_Authority)
 		{
 			// notify the server of the hit
-			ServerNotifyHit(Impact, ShootDir, RandomSeed, ReticleSpread);
+			QueueHitNotify(Impact, ShootDir, RandomSeed, ReticleSpread);
 		}
 		else if (Impact.GetActor() == NULL)
 		{
 			if (Impact.bBlockingHit)
 			{
 				// notify the server of the hit
-				ServerNotifyHit(Impact, ShootDir, RandomSeed, ReticleSpread);
+				QueueHitNotify(Impact, ShootDir, RandomSeed, ReticleSpread);
 			}
 			else
 			{
@@ -158,6 +367,47 @@ void AShooterWeapon_Instant::ProcessInstantHit(const FHitResult& Impact, const F
 	ProcessInstantHit_Confirmed(Impact, Origin, ShootDir, RandomSeed, ReticleSpread);
 }
 
+void AShooterWeapon_Instant::QueueHitNotify(const FHitResult& Impact, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread)
+{
+	if (InstantConfig.HitNotifyBatchTime <= 0.0f)
+	{
+		ServerNotifyHit(Impact, ShootDir, RandomSeed, ReticleSpread);
+		return;
+	}
+
+	PendingHitNotifies.Add(MakeHitBatchEntry(Impact, ShootDir, RandomSeed, ReticleSpread));
+	PendingHitNotifyTimes.Add(GetWorld()->GetTimeSeconds());
+
+	if (PendingHitNotifies.Num() >= InstantConfig.HitNotifyBatchSize)
+	{
+		FlushHitNotifies();
+	}
+	else if (!GetWorldTimerManager().IsTimerActive(TimerHandle_FlushHitNotifies))
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_FlushHitNotifies, this, &AShooterWeapon_Instant::FlushHitNotifies, InstantConfig.HitNotifyBatchTime, false);
+	}
+}
+
+void AShooterWeapon_Instant::FlushHitNotifies()
+{
+	GetWorldTimerManager().ClearTimer(TimerHandle_FlushHitNotifies);
+
+	if (PendingHitNotifies.Num() > 0)
+	{
+		// the server rewinds each hit by how long it was held back
+		const float TimeSeconds = GetWorld()->GetTimeSeconds();
+		for (int32 HitIndex = 0; HitIndex < PendingHitNotifies.Num(); HitIndex++)
+		{
+			const int32 ShotAge = FMath::RoundToInt((TimeSeconds - PendingHitNotifyTimes[HitIndex]) * 1000.0f);
+			PendingHitNotifies[HitIndex].ShotAge = (uint16)FMath::Clamp(ShotAge, 0, (int32)MAX_uint16);
+		}
+
+		ServerNotifyHits(PendingHitNotifies);
+		PendingHitNotifies.Reset();
+		PendingHitNotifyTimes.Reset();
+	}
+}
+
 void AShooterWeapon_Instant::ProcessInstantHit_Confirmed(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread)
 {
 	// handle damage
@@ -217,6 +467,9 @@ void AShooterWeapon_Instant::OnBurstFinished()
 	Super::OnBurstFinished();
 
 	CurrentFiringSpread = 0.0f;
+
+	// don't hold back the end of the burst
+	FlushHitNotifies();
 }
 
 
@@ -245,6 +498,12 @@ void AShooterWeapon_Instant::OnRep_HitNotify()
 
 void AShooterWeapon_Instant::SimulateInstantHit(const FVector& ShotOrigin, int32 RandomSeed, float ReticleSpread)
 {
+	if (InstantConfig.PelletCount > 1)
+	{
+		FirePellets(ShotOrigin, GetAdjustedAim(), RandomSeed, ReticleSpread, true);
+		return;
+	}
+
 	FRandomStream WeaponRandomStream(RandomSeed);
 	const float ConeHalfAngle = FMath::DegreesToRadians(ReticleSpread * 0.5f);
 
@@ -267,7 +526,8 @@ void AShooterWeapon_Instant::SimulateInstantHit(const FVector& ShotOrigin, int32
 
 void AShooterWeapon_Instant::SpawnImpactEffects(const FHitResult& Impact)
 {
-	if (ImpactTemplate && Impact.bBlockingHit)
+	UShooterEffectPool* EffectPool = GetWorld()->GetSubsystem<UShooterEffectPool>();
+	if (ImpactTemplate && EffectPool && Impact.bBlockingHit)
 	{
 		FHitResult UseImpact = Impact;
 
@@ -281,12 +541,7 @@ void AShooterWeapon_Instant::SpawnImpactEffects(const FHitResult& Impact)
 		}
 
 		FTransform const SpawnTransform(Impact.ImpactNormal.Rotation(), Impact.ImpactPoint);
-		AShooterImpactEffect* EffectActor = GetWorld()->SpawnActorDeferred<AShooterImpactEffect>(ImpactTemplate, SpawnTransform);
-		if (EffectActor)
-		{
-			EffectActor->SurfaceHit = UseImpact;
-			UGameplayStatics::FinishSpawningActor(EffectActor, SpawnTransform);
-		}
+		EffectPool->SpawnEffect(ImpactTemplate, SpawnTransform, UseImpact);
 	}
 }
 
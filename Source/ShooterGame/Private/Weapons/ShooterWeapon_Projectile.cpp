@@ -3,9 +3,39 @@
 #include "ShooterGame.h"
 #include "Weapons/ShooterWeapon_Projectile.h"
 #include "Weapons/ShooterProjectile.h"
+#include "Weapons/ShooterProjectilePool.h"
+
+/** Radius of the projectile used for the trajectory traces */
+static const float TrajectoryProjectileRadius = 5.f;
+
+/** Simulation steps per second of the trajectory prediction */
+static const float TrajectorySimFrequency = 20.f;
+
+static int32 TrajectoryAsyncTraces = 1;
+FAutoConsoleVariableRef CVarTrajectoryAsyncTraces(
+	TEXT("p.TrajectoryAsyncTraces"),
+	TrajectoryAsyncTraces,
+	TEXT("Sweep the grenade trajectory preview with async traces, the previous path is shown until they finish\n")
+	TEXT("0: Sync, 1: Async"),
+	ECVF_Default);
+
+bool FTrajectoryInputs::IsNearlyEqual(const FTrajectoryInputs& Other, float LocationTolerance, float AimTolerance) const
+{
+	return FVector::PointsAreNear(Origin, Other.Origin, LocationTolerance)
+		&& FVector::DotProduct(Direction, Other.Direction) >= FMath::Cos(FMath::DegreesToRadians(AimTolerance))
+		&& FMath::IsNearlyEqual(Speed, Other.Speed, KINDA_SMALL_NUMBER)
+		&& FMath::IsNearlyEqual(GravityZ, Other.GravityZ, KINDA_SMALL_NUMBER);
+}
 
 AShooterWeapon_Projectile::AShooterWeapon_Projectile(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
+	TrajectoryLocationTolerance = 1.f;
+	TrajectoryAimTolerance = 0.05f;
+	TrajectoryPointTolerance = 2.f;
+	TrajectoryChordTolerance = 25.f;
+	TrajectoryColliderCheckInterval = 0.1f;
+	TrajectoryRenderMode = ESplineRenderMode::SplineMeshes;
+	bPredictProjectiles = true;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -61,14 +91,62 @@ void AShooterWeapon_Projectile::FireWeapon()
 		}
 	}
 
-	ServerFireProjectile(Origin, ShootDir);
+	// the server has nothing to wait for
+	uint8 PredictionId = 0;
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		PredictionId = SpawnPredictedProjectile(Origin, ShootDir);
+	}
+
+	ServerFireProjectile(Origin, ShootDir, PredictionId);
+}
+
+uint8 AShooterWeapon_Projectile::SpawnPredictedProjectile(const FVector& Origin, const FVector& ShootDir)
+{
+	if (!bPredictProjectiles || ProjectileConfig.ProjectileClass == nullptr)
+	{
+		return 0;
+	}
+
+	LastPredictionId = LastPredictionId % MAX_uint8 + 1;
+
+	FTransform SpawnTM(ShootDir.Rotation(), Origin);
+	AShooterProjectile* Projectile = GetWorld()->SpawnActorDeferred<AShooterProjectile>(ProjectileConfig.ProjectileClass, SpawnTM, this, GetInstigator());
+	if (Projectile == nullptr)
+	{
+		return 0;
+	}
+
+	FVector ProjectileDir = ShootDir;
+	Projectile->InitPredictedProjectile(LastPredictionId);
+	Projectile->InitVelocity(ProjectileDir);
+	UGameplayStatics::FinishSpawningActor(Projectile, SpawnTM);
+
+	PredictedProjectiles.RemoveAll([](const TWeakObjectPtr<AShooterProjectile>& Predicted)
+	{
+		return !Predicted.IsValid();
+	});
+	PredictedProjectiles.Add(Projectile);
+	return LastPredictionId;
+}
+
+AShooterProjectile* AShooterWeapon_Projectile::TakePredictedProjectile(uint8 PredictionId)
+{
+	for (int32 Index = 0; Index < PredictedProjectiles.Num(); Index++)
+	{
+		AShooterProjectile* Projectile = PredictedProjectiles[Index].Get();
+		if (Projectile && Projectile->GetPredictionId() == PredictionId)
+		{
+			PredictedProjectiles.RemoveAtSwap(Index);
+			return Projectile;
+		}
+	}
+	return nullptr;
 }
 
 void AShooterWeapon_Projectile::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
-	/** If there is no dynamic object on the map that can collide with the projectile, you can optimize this to
-	 only update when player moves themselves or moves their aim*/
 	if(GetPawnOwner() && !GetPawnOwner()->IsTargeting() && !GetPawnOwner()->IsRunning())
 	{
 		DrawTrajectory();
@@ -95,7 +173,9 @@ void AShooterWeapon_Projectile::OnEquipFinished()
 		TrajectorySplineActor->SetActorScale3D(FVector{0.1,0.1,0.1});
 		TrajectorySplineActor->ClearNodes();
 		TrajectorySplineActor->SplineMeshMap = TrajectorySplineMap;
+		TrajectorySplineActor->RenderMode = TrajectoryRenderMode;
 		TrajectorySplineActor->UpdateSpline();
+		TrajectoryCache.bValid = false;
 		TrajectorySplineActor->SetReplicates(false);
 	}
 }
@@ -111,62 +191,239 @@ void AShooterWeapon_Projectile::DrawTrajectory()
 	//If gravity is 0 there is no need for a trajectory
 	if(TrajectorySplineActor && ProjectileConfig.ProjectileGravityScale != 0)
 	{
-		FPredictProjectilePathResult ProjectileResult;
-		FPredictProjectilePathParams ProjectileParams;
-		
-		FVector ShootDir = GetAdjustedAim();
-		FVector Origin = GetMuzzleLocation();
-
-		ProjectileParams.StartLocation = Origin;
-		ProjectileParams.LaunchVelocity = ShootDir * ProjectileConfig.ProjectileInitialSpeed;
-		ProjectileParams.TraceChannel = COLLISION_PROJECTILE;
-		ProjectileParams.ProjectileRadius = 5;
-		ProjectileParams.bTraceWithCollision = true;
-		ProjectileParams.bTraceWithChannel = true;
-		ProjectileParams.MaxSimTime = ProjectileConfig.ProjectileLife;
-		ProjectileParams.OverrideGravityZ = GetWorld()->GetGravityZ()*ProjectileConfig.ProjectileGravityScale;
-
-		UGameplayStatics::PredictProjectilePath(GetWorld(), ProjectileParams, ProjectileResult);
-
-		//ProjectileParams.LaunchVelocity = ProjectileConfig.ProjectileInitialSpeed;
-		TrajectorySplineActor->SetActorHiddenInGame(true);
-		TrajectorySplineActor->ClearNodes();
-		
-		for(int i = 0; i < ProjectileResult.PathData.Num(); i++)
+		// sweeps issued last frame are done now, their path may already match the current inputs
+		if(PendingTrajectory.IsActive())
 		{
-			TrajectorySplineActor->AddNode(ProjectileResult.PathData[i].Location);
+			FinishAsyncTrajectory();
+		}
+
+		FTrajectoryInputs Inputs;
+		Inputs.Origin = GetMuzzleLocation();
+		Inputs.Direction = GetAdjustedAim();
+		Inputs.Speed = ProjectileConfig.ProjectileInitialSpeed;
+		Inputs.GravityZ = GetWorld()->GetGravityZ()*ProjectileConfig.ProjectileGravityScale;
+
+		// the path only changes when the player moves, aims or something moves into it
+		if(!IsTrajectoryDirty(Inputs))
+		{
+			return;
+		}
+
+		if(TrajectoryAsyncTraces == 0)
+		{
+			PendingTrajectory.Reset();
+			PredictTrajectory(Inputs);
+		}
+		else if(!PendingTrajectory.IsActive() || !PendingTrajectory.Inputs.IsNearlyEqual(Inputs, TrajectoryLocationTolerance, TrajectoryAimTolerance))
+		{
+			StartAsyncTrajectory(Inputs);
 		}
-		TrajectorySplineActor->UpdateSpline();
-		TrajectorySplineActor->SetActorHiddenInGame(false);
 	}
 }
 
 void AShooterWeapon_Projectile::ClearTrajectory()
 {
-	if(TrajectorySplineActor == nullptr)
+	PendingTrajectory.Reset();
+
+	// nothing drawn since the last clear
+	if(TrajectorySplineActor == nullptr || !TrajectoryCache.bValid)
 	{
 		return;
 	}
+	TrajectoryCache.bValid = false;
+	TrajectorySplineActor->ClearNodes();
+	TrajectorySplineActor->UpdateSpline();
+}
+
+FBallisticPath AShooterWeapon_Projectile::GetTrajectoryPath(const FTrajectoryInputs& Inputs) const
+{
+	return FBallisticPath(Inputs.Origin, Inputs.Direction * Inputs.Speed, Inputs.GravityZ, ProjectileConfig.ProjectileLife, TrajectorySimFrequency);
+}
+
+void AShooterWeapon_Projectile::PredictTrajectory(const FTrajectoryInputs& Inputs)
+{
+	// the projectile ignores its instigator, so does its trajectory
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(Trajectory), false, GetPawnOwner());
+	const FBallisticPath Path = GetTrajectoryPath(Inputs);
+
+	FHitResult Hit;
+	int32 HitStep = INDEX_NONE;
+	const bool bHit = Path.Sweep(GetWorld(), Path.GetStepStride(TrajectoryChordTolerance), TrajectoryProjectileRadius, COLLISION_PROJECTILE, QueryParams, Hit, HitStep);
+	SetTrajectoryPath(Inputs, Path, bHit ? &Hit : nullptr, HitStep);
+}
+
+void AShooterWeapon_Projectile::StartAsyncTrajectory(const FTrajectoryInputs& Inputs)
+{
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AsyncTrajectory), false, GetPawnOwner());
+	const FBallisticPath Path = GetTrajectoryPath(Inputs);
+
+	PendingTrajectory.Reset();
+	PendingTrajectory.Inputs = Inputs;
+	PendingTrajectory.Stride = Path.GetStepStride(TrajectoryChordTolerance);
+	PendingTrajectory.IssuedFrame = GFrameCounter;
+
+	// the chords don't depend on each other's results, sweep all of them at once
+	for(int32 FirstStep = 0; FirstStep < Path.GetNumSteps(); FirstStep += PendingTrajectory.Stride)
+	{
+		const int32 LastStep = FMath::Min(FirstStep + PendingTrajectory.Stride, Path.GetNumSteps());
+		// a single step chord is the step itself, sweep it like the sync path so its hit is exact
+		const float ChordRadius = LastStep - FirstStep == 1 ? TrajectoryProjectileRadius : TrajectoryProjectileRadius + Path.GetChordSag(FirstStep, LastStep);
+		const FCollisionShape ChordShape = FCollisionShape::MakeSphere(ChordRadius);
+		PendingTrajectory.Handles.Add(GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Path.GetLocation(Path.GetStepTime(FirstStep)), Path.GetLocation(Path.GetStepTime(LastStep)), FQuat::Identity, COLLISION_PROJECTILE, ChordShape, QueryParams));
+	}
+}
+
+void AShooterWeapon_Projectile::FinishAsyncTrajectory()
+{
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AsyncTrajectory), false, GetPawnOwner());
+	const FBallisticPath Path = GetTrajectoryPath(PendingTrajectory.Inputs);
+
+	FHitResult Hit;
+	int32 HitStep = INDEX_NONE;
+	for(int32 Index = 0; Index < PendingTrajectory.Handles.Num(); Index++)
+	{
+		FTraceDatum TraceData;
+		if(!GetWorld()->QueryTraceData(PendingTrajectory.Handles[Index], TraceData))
+		{
+			// results are only kept for one frame, sweeps we missed have to be issued again
+			if(GFrameCounter > PendingTrajectory.IssuedFrame + 1)
+			{
+				PendingTrajectory.Reset();
+			}
+			return;
+		}
+
+		const FHitResult* ChordHit = FHitResult::GetFirstBlockingHit(TraceData.OutHits);
+		if(ChordHit == nullptr)
+		{
+			continue;
+		}
+
+		const int32 FirstStep = Index * PendingTrajectory.Stride;
+		const int32 LastStep = FMath::Min(FirstStep + PendingTrajectory.Stride, Path.GetNumSteps());
+		if(LastStep - FirstStep == 1)
+		{
+			// a single step chord was swept without inflation, its hit is exact
+			Hit = *ChordHit;
+			HitStep = FirstStep;
+			break;
+		}
+
+		// refine the chord on the game thread, it only covers a few steps
+		if(Path.SweepSteps(GetWorld(), FirstStep, LastStep, TrajectoryProjectileRadius, COLLISION_PROJECTILE, QueryParams, Hit, HitStep))
+		{
+			break;
+		}
+	}
+
+	SetTrajectoryPath(PendingTrajectory.Inputs, Path, HitStep != INDEX_NONE ? &Hit : nullptr, HitStep);
+	PendingTrajectory.Reset();
+}
+
+void AShooterWeapon_Projectile::SetTrajectoryPath(const FTrajectoryInputs& Inputs, const FBallisticPath& Path, const FHitResult* Hit, int32 HitStep)
+{
+	TArray<FVector> PathPoints;
+	Path.GetPoints(Hit ? HitStep : Path.GetNumSteps(), Path.GetStepStride(TrajectoryPointTolerance), PathPoints);
+	if(Hit)
+	{
+		PathPoints.Add(Hit->Location);
+	}
+
 	TrajectorySplineActor->ClearNodes();
+
+	TrajectoryCache.Bounds.Init();
+	for(const FVector& PathPoint : PathPoints)
+	{
+		TrajectorySplineActor->AddNode(PathPoint);
+		TrajectoryCache.Bounds += PathPoint;
+	}
 	TrajectorySplineActor->UpdateSpline();
+
+	TrajectoryCache.Inputs = Inputs;
+	TrajectoryCache.Bounds = TrajectoryCache.Bounds.ExpandBy(TrajectoryProjectileRadius);
+	TrajectoryCache.bValid = true;
+	GatherTrajectoryColliders(TrajectoryCache.Colliders, TrajectoryCache.ColliderLocations);
+	TrajectoryCache.LastColliderCheckTime = GetWorld()->GetTimeSeconds();
+}
+
+bool AShooterWeapon_Projectile::IsTrajectoryDirty(const FTrajectoryInputs& Inputs)
+{
+	if(!TrajectoryCache.bValid || !Inputs.IsNearlyEqual(TrajectoryCache.Inputs, TrajectoryLocationTolerance, TrajectoryAimTolerance))
+	{
+		return true;
+	}
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	if(TimeSeconds - TrajectoryCache.LastColliderCheckTime < TrajectoryColliderCheckInterval)
+	{
+		return false;
+	}
+	TrajectoryCache.LastColliderCheckTime = TimeSeconds;
+
+	return HaveTrajectoryCollidersChanged();
+}
+
+bool AShooterWeapon_Projectile::HaveTrajectoryCollidersChanged()
+{
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Colliders;
+	TArray<FVector> ColliderLocations;
+	GatherTrajectoryColliders(Colliders, ColliderLocations);
+
+	if(Colliders.Num() != TrajectoryCache.Colliders.Num())
+	{
+		return true;
+	}
+
+	for(int32 Index = 0; Index < Colliders.Num(); Index++)
+	{
+		const int32 CachedIndex = TrajectoryCache.Colliders.Find(Colliders[Index]);
+		if(CachedIndex == INDEX_NONE || !FVector::PointsAreNear(ColliderLocations[Index], TrajectoryCache.ColliderLocations[CachedIndex], TrajectoryLocationTolerance))
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
-bool AShooterWeapon_Projectile::ServerFireProjectile_Validate(FVector Origin, FVector_NetQuantizeNormal ShootDir)
+void AShooterWeapon_Projectile::GatherTrajectoryColliders(TArray<TWeakObjectPtr<UPrimitiveComponent>>& OutColliders, TArray<FVector>& OutLocations) const
+{
+	OutColliders.Reset();
+	OutLocations.Reset();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TrajectoryColliders), false, GetPawnOwner());
+	QueryParams.AddIgnoredActor(this);
+
+	// only what the trajectory traces would collide with can change the path
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByChannel(Overlaps, TrajectoryCache.Bounds.GetCenter(), FQuat::Identity, COLLISION_PROJECTILE, FCollisionShape::MakeBox(TrajectoryCache.Bounds.GetExtent()), QueryParams);
+
+	for(const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if(Component && Component->Mobility == EComponentMobility::Movable)
+		{
+			OutColliders.Add(Component);
+			OutLocations.Add(Component->GetComponentLocation());
+		}
+	}
+}
+
+bool AShooterWeapon_Projectile::ServerFireProjectile_Validate(FVector Origin, FVector_NetQuantizeNormal ShootDir, uint8 PredictionId)
 {
 	return true;
 }
 
-void AShooterWeapon_Projectile::ServerFireProjectile_Implementation(FVector Origin, FVector_NetQuantizeNormal ShootDir)
+void AShooterWeapon_Projectile::ServerFireProjectile_Implementation(FVector Origin, FVector_NetQuantizeNormal ShootDir, uint8 PredictionId)
 {
 	FTransform SpawnTM(ShootDir.Rotation(), Origin);
-	AShooterProjectile* Projectile = Cast<AShooterProjectile>(UGameplayStatics::BeginDeferredActorSpawnFromClass(this, ProjectileConfig.ProjectileClass, SpawnTM));
-	if (Projectile)
+	UShooterProjectilePool* ProjectilePool = GetWorld()->GetSubsystem<UShooterProjectilePool>();
+	if (ProjectilePool)
 	{
-		Projectile->SetInstigator(GetInstigator());
-		Projectile->SetOwner(this);
-		Projectile->InitVelocity(ShootDir);
-
-		UGameplayStatics::FinishSpawningActor(Projectile, SpawnTM);
+		AShooterProjectile* Projectile = ProjectilePool->FireProjectile(ProjectileConfig.ProjectileClass, SpawnTM, ShootDir, this, GetInstigator());
+		if (Projectile)
+		{
+			Projectile->SetPredictionId(PredictionId);
+		}
 	}
 }
 
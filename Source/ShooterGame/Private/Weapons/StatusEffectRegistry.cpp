@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Weapons/StatusEffectRegistry.h"
+
+namespace
+{
+	struct FStatusEffectKernelTable
+	{
+		FStatusEffectKernel Kernels[FStatusEffectRegistry::Num];
+
+		FStatusEffectKernelTable()
+		{
+			FStatusEffectRegistry::ForEach([this](auto EffectTag)
+			{
+				using FEffectType = typename decltype(EffectTag)::Type;
+				static_assert((int32)FEffectType::Type < FStatusEffectRegistry::Num, "Every registered effect needs its own EStatusEffectType value below FStatusEffectRegistry::Num");
+
+				FStatusEffectKernel& Kernel = Kernels[(int32)FEffectType::Type];
+				Kernel.Start = &FEffectType::Start;
+				Kernel.Update = &FEffectType::Update;
+				Kernel.End = &FEffectType::End;
+			});
+		}
+	};
+}
+
+const FStatusEffectKernel* FStatusEffectRegistry::GetKernel(EStatusEffectType Type)
+{
+	static const FStatusEffectKernelTable KernelTable;
+
+	const int32 TypeIndex = (int32)Type;
+	if(TypeIndex < 0 || TypeIndex >= Num)
+	{
+		return nullptr;
+	}
+	return &KernelTable.Kernels[TypeIndex];
+}
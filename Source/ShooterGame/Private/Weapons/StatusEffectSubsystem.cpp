@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShooterGame.h"
+#include "Weapons/StatusEffectSubsystem.h"
+
+/** Update rate of the effect types that are not listed in the config */
+static const float StatusEffectDefaultUpdateRate = 1.0f;
+
+/** Max number of fixed steps run in one frame, the rest of a long frame is added to the last step */
+static const int32 StatusEffectMaxStepsPerFrame = 8;
+
+int32 FStatusEffectStorage::Add(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target)
+{
+	Values.Add(Data.Value);
+	LifeTimes.Add(Data.LifeTime);
+	UnpaidTimes.Add(0.f);
+	Owners.Add(Owner);
+	return Targets.Add(Target);
+}
+
+void FStatusEffectStorage::RemoveAtSwap(int32 Index)
+{
+	Values.RemoveAtSwap(Index, 1, false);
+	LifeTimes.RemoveAtSwap(Index, 1, false);
+	UnpaidTimes.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	Targets.RemoveAtSwap(Index, 1, false);
+}
+
+void FStatusEffectStorage::Reset()
+{
+	Values.Reset();
+	LifeTimes.Reset();
+	UnpaidTimes.Reset();
+	Owners.Reset();
+	Targets.Reset();
+}
+
+bool UStatusEffectSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void UStatusEffectSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	for(int32 TypeIndex = 0; TypeIndex < FStatusEffectRegistry::Num; TypeIndex++)
+	{
+		const float* UpdateRate = UpdateRates.Find((EStatusEffectType)TypeIndex);
+		UpdateIntervals[TypeIndex] = 1.f / FMath::Max(UpdateRate ? *UpdateRate : StatusEffectDefaultUpdateRate, KINDA_SMALL_NUMBER);
+		UpdateAccumulators[TypeIndex] = 0.f;
+	}
+	StepAccumulator = 0.f;
+}
+
+void UStatusEffectSubsystem::Deinitialize()
+{
+	for(FStatusEffectStorage& Batch : Batches)
+	{
+		Batch.Reset();
+	}
+	PendingDamage.Reset();
+	Super::Deinitialize();
+}
+
+ETickableTickType UStatusEffectSubsystem::GetTickableTickType() const
+{
+	// the class default object is registered as well, it should never tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UStatusEffectSubsystem::IsTickable() const
+{
+	return GetNumEffects() > 0;
+}
+
+int32 UStatusEffectSubsystem::GetNumEffects() const
+{
+	int32 NumEffects = 0;
+	for(const FStatusEffectStorage& Batch : Batches)
+	{
+		NumEffects += Batch.Num();
+	}
+	return NumEffects;
+}
+
+TStatId UStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+void UStatusEffectSubsystem::AddEffect(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target)
+{
+	const FStatusEffectKernel* Kernel = FStatusEffectRegistry::GetKernel(Data.Type);
+	if(Kernel == nullptr || Target == nullptr)
+	{
+		return;
+	}
+
+	if(MergeEffect(Data, Owner, Target))
+	{
+		return;
+	}
+
+	Batches[(int32)Data.Type].Add(Data, Owner, Target);
+	Kernel->Start(*this, Data.Value, Owner, Target);
+}
+
+bool UStatusEffectSubsystem::MergeEffect(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target)
+{
+	FStatusEffectStorage& Effects = Batches[(int32)Data.Type];
+	// strongest only competes with effects modifying in the same direction, a haste never replaces a slow
+	const bool bMergeSameDirection = Data.Stacking == EStatusEffectStacking::Strongest;
+	int32 NumStacks = 0;
+	int32 MergeIndex = INDEX_NONE;
+	for(int32 Index = 0; Index < Effects.Num(); Index++)
+	{
+		if(Effects.Targets[Index].Get() != Target)
+		{
+			continue;
+		}
+
+		if(bMergeSameDirection && (Effects.Values[Index] < 0.f) != (Data.Value < 0.f))
+		{
+			continue;
+		}
+
+		NumStacks++;
+		// merge into the effect closest to expiring
+		if(MergeIndex == INDEX_NONE || Effects.LifeTimes[Index] < Effects.LifeTimes[MergeIndex])
+		{
+			MergeIndex = Index;
+		}
+	}
+
+	if(MergeIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	switch(Data.Stacking)
+	{
+		case EStatusEffectStacking::Stack:
+			if(NumStacks < FMath::Max(Data.MaxStacks, 1))
+			{
+				return false;
+			}
+			// fall through, a full stack refreshes its oldest effect
+
+		case EStatusEffectStacking::Refresh:
+			if(Effects.Owners[MergeIndex].Get() != Owner)
+			{
+				// settle the time the effect was active for under its old owner, so it keeps the credit for it
+				const FStatusEffectKernel* Kernel = FStatusEffectRegistry::GetKernel(Data.Type);
+				Kernel->Update(*this, Effects.Values[MergeIndex], Effects.UnpaidTimes[MergeIndex], Effects.Owners[MergeIndex].Get(), Target);
+				Effects.UnpaidTimes[MergeIndex] = 0.f;
+				Effects.Owners[MergeIndex] = Owner;
+			}
+			Effects.LifeTimes[MergeIndex] = FMath::Max(Effects.LifeTimes[MergeIndex], Data.LifeTime);
+			return true;
+
+		case EStatusEffectStacking::Strongest:
+			// both values have the same sign here, the stronger one is further away from zero
+			if(Data.Value < 0.f ? Data.Value <= Effects.Values[MergeIndex] : Data.Value >= Effects.Values[MergeIndex])
+			{
+				// replace the modification of the weaker effect with the new one
+				// settle the time the old value was active for before replacing it
+				const FStatusEffectKernel* Kernel = FStatusEffectRegistry::GetKernel(Data.Type);
+				Kernel->Update(*this, Effects.Values[MergeIndex], Effects.UnpaidTimes[MergeIndex], Effects.Owners[MergeIndex].Get(), Target);
+				Effects.UnpaidTimes[MergeIndex] = 0.f;
+				Kernel->End(*this, Effects.Values[MergeIndex], Effects.Owners[MergeIndex].Get(), Target);
+				Effects.Values[MergeIndex] = Data.Value;
+				Effects.LifeTimes[MergeIndex] = Data.LifeTime;
+				Effects.Owners[MergeIndex] = Owner;
+				Kernel->Start(*this, Data.Value, Owner, Target);
+			}
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+void UStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	const float StepTime = 1.f / FMath::Max(StepRate, 1.f);
+	const float MaxStepTime = StepTime * StatusEffectMaxStepsPerFrame;
+	StepAccumulator += DeltaTime;
+
+	// a hitch still advances life times and pays damage over time for the whole frame,
+	// only the number of steps is capped
+	float OverflowTime = FMath::Max(StepAccumulator - MaxStepTime, 0.f);
+	StepAccumulator -= OverflowTime;
+	while(StepAccumulator >= StepTime)
+	{
+		StepAccumulator -= StepTime;
+		const bool bLastStep = StepAccumulator < StepTime;
+		StepEffects(bLastStep ? StepTime + OverflowTime : StepTime);
+		if(bLastStep)
+		{
+			OverflowTime = 0.f;
+		}
+	}
+
+	ApplyPendingDamage();
+}
+
+void UStatusEffectSubsystem::StepEffects(float StepTime)
+{
+	FStatusEffectRegistry::ForEach([this, StepTime](auto EffectTag)
+	{
+		using FEffectType = typename decltype(EffectTag)::Type;
+		StepBatch<FEffectType>(Batches[(int32)FEffectType::Type], StepTime);
+	});
+}
+
+template<typename FEffectType>
+void UStatusEffectSubsystem::StepBatch(FStatusEffectStorage& Batch, float StepTime)
+{
+	const int32 TypeIndex = (int32)FEffectType::Type;
+	UpdateAccumulators[TypeIndex] += StepTime;
+	const bool bUpdateDue = UpdateAccumulators[TypeIndex] >= UpdateIntervals[TypeIndex];
+	if(bUpdateDue)
+	{
+		UpdateAccumulators[TypeIndex] = FMath::Fmod(UpdateAccumulators[TypeIndex], UpdateIntervals[TypeIndex]);
+	}
+
+	// walk backwards so removed effects can be swapped with already updated ones
+	for(int32 Index = Batch.Num() - 1; Index >= 0; Index--)
+	{
+		// the target is gone, nothing left to modify
+		if(!Batch.Targets[Index].IsValid())
+		{
+			Batch.RemoveAtSwap(Index);
+			continue;
+		}
+
+		Batch.UnpaidTimes[Index] += FMath::Min(StepTime, Batch.LifeTimes[Index]);
+		Batch.LifeTimes[Index] -= StepTime;
+		const bool bExpired = Batch.LifeTimes[Index] <= 0.f;
+
+		// expiring effects are updated one last time for the remainder of their life time
+		if(bUpdateDue || bExpired)
+		{
+			FEffectType::Update(*this, Batch.Values[Index], Batch.UnpaidTimes[Index], Batch.Owners[Index].Get(), Batch.Targets[Index].Get());
+			Batch.UnpaidTimes[Index] = 0.f;
+		}
+
+		if(bExpired)
+		{
+			FEffectType::End(*this, Batch.Values[Index], Batch.Owners[Index].Get(), Batch.Targets[Index].Get());
+			Batch.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void UStatusEffectSubsystem::AddPendingDamage(float Damage, AShooterCharacter* Owner, AShooterCharacter* Target)
+{
+	if(Target == nullptr)
+	{
+		return;
+	}
+
+	FPendingStatusDamage* Pending = PendingDamage.FindByPredicate([Owner, Target](const FPendingStatusDamage& Entry)
+	{
+		return Entry.Target.Get() == Target && Entry.Owner.Get() == Owner;
+	});
+
+	if(Pending)
+	{
+		Pending->Damage += Damage;
+	}
+	else
+	{
+		PendingDamage.Add(FPendingStatusDamage{Target, Owner, Damage});
+	}
+}
+
+void UStatusEffectSubsystem::ApplyPendingDamage()
+{
+	// damage is only merged per owner so friendly fire rules and kill credit stay with the right instigator
+	for(const FPendingStatusDamage& Pending : PendingDamage)
+	{
+		AShooterCharacter* Target = Pending.Target.Get();
+		AShooterCharacter* Owner = Pending.Owner.Get();
+		if(Target)
+		{
+			Target->TakeDamage(Pending.Damage, FDamageEvent(UDamageType::StaticClass()), Owner ? Owner->GetController() : nullptr, Owner);
+		}
+	}
+	PendingDamage.Reset();
+}
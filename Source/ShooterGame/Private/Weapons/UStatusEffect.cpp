@@ -2,55 +2,46 @@
 
 #include "ShooterGame.h"
 #include "Weapons/UStatusEffect.h"
+#include "Weapons/StatusEffectSubsystem.h"
 
 #include "LOGHelper.h"
 
-void UStatusEffect::Init(const FStatusEffectData& EffectData, AShooterCharacter* OwnerChar, AShooterCharacter* TargetChar)
-{
-	Data = EffectData;
-	Owner = OwnerChar;
-	Target = TargetChar;
-}
-
-void UEffectBurn::Start()
+void FEffectBurn::Start(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
 	if(Target)
 	{
-		Target->TakeDamage(Data.Value, FDamageEvent(UDamageType::StaticClass()), Owner->GetController(), Owner);
+		Target->TakeDamage(Value, FDamageEvent(UDamageType::StaticClass()), Owner ? Owner->GetController() : nullptr, Owner);
 	}
 }
 
-void UEffectBurn::Update()
+void FEffectBurn::Update(UStatusEffectSubsystem& EffectSubsystem, float Value, float DeltaSeconds, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
-	if(Target)
-	{
-		Target->TakeDamage(Data.Value, FDamageEvent(UDamageType::StaticClass()), Owner->GetController(), Owner);
-	}
-	Data.LifeTime--;
+	// damage over time is summed with the other burns on the same target and applied once at the end of the update
+	EffectSubsystem.AddPendingDamage(Value * DeltaSeconds, Owner, Target);
 }
 
-void UEffectBurn::End()
+void FEffectBurn::End(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
 	//Do Nothing
 }
 
-void UEffectSpeed::Start()
+void FEffectSpeed::Start(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
 	if(Target && Target->GetMovementComponent())
 	{
-		Target->AddSpeedModifier(Data.Value);
+		Target->AddSpeedModifier(Value);
 	}
 }
 
-void UEffectSpeed::Update()
+void FEffectSpeed::Update(UStatusEffectSubsystem& EffectSubsystem, float Value, float DeltaSeconds, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
-	Data.LifeTime--;
+	//Do Nothing
 }
 
-void UEffectSpeed::End()
+void FEffectSpeed::End(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target)
 {
 	if(Target && Target->GetMovementComponent())
 	{
-		Target->AddSpeedModifier(-Data.Value);
+		Target->AddSpeedModifier(-Value);
 	}
 }
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterEffectPool.generated.h"
+
+class AShooterPooledEffect;
+
+/** Effect asked for this frame, played or dropped when the pool ticks */
+struct FShooterEffectRequest
+{
+	TSubclassOf<AShooterPooledEffect> EffectClass;
+	FTransform Transform;
+	FHitResult SurfaceHit;
+	/** Squared distance to the closest local view */
+	float ViewDistSq;
+};
+
+/** Effect played recently, used for the area budget */
+struct FShooterRecentEffect
+{
+	UClass* EffectClass;
+	FVector Location;
+	float PlayTime;
+};
+
+/** Effects of one class waiting to be played again */
+USTRUCT()
+struct FShooterEffectPoolList
+{
+	GENERATED_BODY()
+
+	/** hidden effects */
+	UPROPERTY()
+	TArray<AShooterPooledEffect*> Effects;
+};
+
+/** Plays local effects with a budget and reuses their actors instead of spawning new ones.
+ * Requests are collected over the frame and played at its end, closest to a local view first.
+ * Requests over the frame budget, or close to enough recent effects of the same class, are dropped.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UShooterEffectPool : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** Ask for an effect of the given class, it is played at the end of the frame if it fits the budget */
+	void SpawnEffect(TSubclassOf<AShooterPooledEffect> EffectClass, const FTransform& Transform, const FHitResult& SurfaceHit);
+
+	/** Take back an effect that is done, it is destroyed if the pool of its class is full */
+	void ReleaseEffect(AShooterPooledEffect* Effect);
+
+private:
+	/** Play the effect with a pooled actor, or a new one if the pool is empty */
+	void PlayEffect(const FShooterEffectRequest& Request);
+
+	/** True if there are already MaxEffectsPerArea recent effects of the class around the location */
+	bool IsAreaFull(UClass* EffectClass, const FVector& Location) const;
+
+	/** Max number of effects played in one frame */
+	UPROPERTY(config)
+	int32 MaxEffectsPerFrame = 16;
+
+	/** Max number of effects of one class played within AreaRadius over AreaTime */
+	UPROPERTY(config)
+	int32 MaxEffectsPerArea = 3;
+
+	/** Radius of the area budget */
+	UPROPERTY(config)
+	float AreaRadius = 100.f;
+
+	/** Time in seconds an effect counts for the area budget */
+	UPROPERTY(config)
+	float AreaTime = 0.2f;
+
+	/** Max number of effects kept for each class */
+	UPROPERTY(config)
+	int32 MaxPooledEffects = 32;
+
+	/** Pooled effects by class */
+	UPROPERTY(Transient)
+	TMap<UClass*, FShooterEffectPoolList> Pools;
+
+	/** Requests of this frame */
+	TArray<FShooterEffectRequest> PendingEffects;
+
+	/** Effects played within AreaTime */
+	TArray<FShooterRecentEffect> RecentEffects;
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ShooterTypes.h"
+#include "Effects/ShooterPooledEffect.h"
 #include "ShooterExplosionEffect.generated.h"
 
 //
@@ -10,7 +11,7 @@
 // Each explosion type should be defined as separate blueprint
 //
 UCLASS(Abstract, Blueprintable)
-class AShooterExplosionEffect : public AActor
+class AShooterExplosionEffect : public AShooterPooledEffect
 {
 	GENERATED_UCLASS_BODY()
 
@@ -36,22 +37,26 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category=Effect)
 	struct FDecalData Decal;
 
-	/** surface data for spawning */
-	UPROPERTY(BlueprintReadOnly, Category=Surface)
-	FHitResult SurfaceHit;
+	/** cache the light intensity to fade from */
+	virtual void PostInitializeComponents() override;
 
 	/** update fading light */
 	virtual void Tick(float DeltaSeconds) override;
 
-protected:
 	/** spawn explosion */
-	virtual void BeginPlay() override;
+	virtual void PlayEffect() override;
 
 private:
 
+	/** time the explosion was played at */
+	float PlayTime;
+
 	/** Point light component name */
 	FName ExplosionLightComponentName;
 
+	/** intensity of the explosion light in the class defaults */
+	float DefaultLightIntensity;
+
 public:
 	/** Returns ExplosionLight subobject **/
 	FORCEINLINE UPointLightComponent* GetExplosionLight() const { return ExplosionLight; }
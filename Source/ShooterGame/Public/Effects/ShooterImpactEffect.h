@@ -3,6 +3,7 @@
 #pragma once
 
 #include "ShooterTypes.h"
+#include "Effects/ShooterPooledEffect.h"
 #include "ShooterImpactEffect.generated.h"
 
 //
@@ -10,7 +11,7 @@
 // Each impact type should be defined as separate blueprint
 //
 UCLASS(Abstract, Blueprintable)
-class AShooterImpactEffect : public AActor
+class AShooterImpactEffect : public AShooterPooledEffect
 {
 	GENERATED_UCLASS_BODY()
 
@@ -90,12 +91,8 @@ class AShooterImpactEffect : public AActor
 	UPROPERTY(EditDefaultsOnly, Category=Defaults)
 	struct FDecalData DefaultDecal;
 
-	/** surface data for spawning */
-	UPROPERTY(BlueprintReadOnly, Category=Surface)
-	FHitResult SurfaceHit;
-
 	/** spawn effect */
-	virtual void PostInitializeComponents() override;
+	virtual void PlayEffect() override;
 
 protected:
 
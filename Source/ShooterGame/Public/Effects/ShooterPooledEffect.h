@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterPooledEffect.generated.h"
+
+//
+// Base for local effects that are spawned through UShooterEffectPool - NOT replicated to clients
+// The same actor is played again each time it is taken from the pool
+//
+UCLASS(Abstract)
+class AShooterPooledEffect : public AActor
+{
+	GENERATED_UCLASS_BODY()
+
+	/** surface data for spawning */
+	UPROPERTY(BlueprintReadOnly, Category=Surface)
+	FHitResult SurfaceHit;
+
+	/** show the effect at the current transform, called when spawned and each time it is reused */
+	virtual void PlayEffect();
+
+protected:
+	/** play the first time */
+	virtual void BeginPlay() override;
+
+	/** the effect is over, hand it back to the pool */
+	void FinishEffect();
+};
@@ -10,6 +10,9 @@
 DECLARE_MULTICAST_DELEGATE_TwoParams(FOnShooterCharacterEquipWeapon, AShooterCharacter*, AShooterWeapon* /* new */);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FOnShooterCharacterUnEquipWeapon, AShooterCharacter*, AShooterWeapon* /* old */);
 
+/** Corners of the bounding box checked for pausing replication, fixed size so building them never allocates */
+typedef TArray<FVector, TFixedAllocator<8>> FPauseReplicationCheckPoints;
+
 UCLASS(Abstract)
 class AShooterCharacter : public ACharacter
 {
@@ -32,6 +35,21 @@ class AShooterCharacter : public ACharacter
 	/** [server] perform PlayerState related setup */
 	virtual void PossessedBy(class AController* C) override;
 
+	/** [server] stop playing local player sounds */
+	virtual void UnPossessed() override;
+
+	/** [client] switch between local and remote player sounds */
+	virtual void OnRep_Controller() override;
+
+	/** change the significance tier and the tick interval that goes with it */
+	void SetSignificance(EShooterCharacterSignificance::Type NewSignificance, float TickInterval);
+
+	/** get the significance tier */
+	EShooterCharacterSignificance::Type GetSignificance() const
+	{
+		return Significance;
+	}
+
 	/** [client] perform PlayerState related setup */
 	virtual void OnRep_PlayerState() override;
 
@@ -248,14 +266,17 @@ class AShooterCharacter : public ACharacter
 	UFUNCTION(BlueprintCallable, Category = Pawn)
 	float GetRunningSpeedModifier() const;
 
-	/** Add a float to the speed modifier of this pawn */
+	/** [server] Add a float to the speed modifier of this pawn, the owning client predicts it through UShooterCharacterMovement */
 	UFUNCTION(BlueprintCallable, Category = Pawn)
 	void AddSpeedModifier(float Speed);
 
-	/** Get the modifier value for max speed */
+	/** Get the modifier value for max speed, only up to date on the server */
 	UFUNCTION(BlueprintCallable, Category = Pawn)
 	float GetSpeedModifier() const;
 
+	/** speed modifier change scheduled for the owning client by UShooterCharacterMovement */
+	FORCEINLINE FScheduledSpeedModifier& GetScheduledSpeedModifier() { return ScheduledSpeedModifier; }
+
 	/** get running state */
 	UFUNCTION(BlueprintCallable, Category = Pawn)
 	bool IsRunning() const;
@@ -273,8 +294,8 @@ class AShooterCharacter : public ACharacter
 	/** returns percentage of health when low health effects should start */
 	float GetLowHealthPercentage() const;
 
-	/** Apply a status effect to this character */
-	void ApplyStatusEffect(UStatusEffect* Effect);
+	/** Apply a status effect to this character, merged with the active effects of the same type by its stacking rule */
+	void ApplyStatusEffect(const FStatusEffectData& EffectData, AShooterCharacter* EffectOwner);
 
 	/*
 	* Get either first or third person mesh.
@@ -290,14 +311,6 @@ private:
 	/** pawn mesh: 1st person view */
 	UPROPERTY(VisibleDefaultsOnly, Category = Mesh)
 	USkeletalMeshComponent* Mesh1P;
-	
-	/** Active status effects on this character */
-	UPROPERTY()
-	TArray<UStatusEffect*> ActiveStatusEffects;
-
-	/** Update a status effect on this character */
-	UFUNCTION()
-	void UpdateStatusEffect(UStatusEffect* Effect);
 
 protected:
 
@@ -340,6 +353,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = Pawn)
 	float SpeedModifier;
 
+	/** speed modifier and the client move it changes at, only needed by the owning client */
+	UPROPERTY(Transient, Replicated)
+	FScheduledSpeedModifier ScheduledSpeedModifier;
+
 	/** current running state */
 	UPROPERTY(Transient, Replicated)
 	uint8 bWantsToRun : 1;
@@ -420,6 +437,15 @@ private:
 	/** Whether or not the character is moving (based on movement input). */
 	bool IsMoving();
 
+	/** significance tier, set by UShooterCharacterSignificance */
+	EShooterCharacterSignificance::Type Significance;
+
+	/** Tell the local player sound nodes if this character is locally controlled, when that changes */
+	void UpdateLocalPlayerSounds();
+
+	/** Last locally controlled state sent to the local player sound nodes, they treat unknown characters as remote */
+	bool bLocalPlayerSounds;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Damage & death
 
@@ -460,6 +486,9 @@ public:
 
 	/** Called on the actor right before replication occurs */
 	virtual void PreReplication(IRepChangedPropertyTracker & ChangedPropertyTracker) override;
+
+	/** Builds list of points to check for pausing replication for a connection*/
+	void BuildPauseReplicationCheckPoints(FPauseReplicationCheckPoints& RelevancyCheckPoints) const;
 protected:
 	/** notification when killed, for both the server and client. */
 	virtual void OnDeath(float KillingDamage, struct FDamageEvent const& DamageEvent, class APawn* InstigatingPawn, class AActor* DamageCauser);
@@ -505,9 +534,6 @@ protected:
 	UFUNCTION(reliable, server, WithValidation)
 	void ServerSetRunning(bool bNewRunning, bool bToggle);
 
-	/** Builds list of points to check for pausing replication for a connection*/
-	void BuildPauseReplicationCheckPoints(TArray<FVector>& RelevancyCheckPoints);
-
 protected:
 	/** Returns Mesh1P subobject **/
 	FORCEINLINE USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
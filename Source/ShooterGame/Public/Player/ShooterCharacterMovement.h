@@ -13,5 +13,31 @@ class UShooterCharacterMovement : public UCharacterMovementComponent
 	GENERATED_UCLASS_BODY()
 
 	virtual float GetMaxSpeed() const override;
+
+	/** remember the time stamp of the move being performed, for server moves and client replays */
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+	/** [local + server] set the speed modifier the character starts with */
+	void InitSpeedModifier(float Modifier);
+
+	/** [server] change the speed modifier, a remote owning client gets it ahead of the moves it applies to */
+	void ScheduleSpeedModifier(float Modifier);
+
+	/** get the speed modifier for the move being performed */
+	float GetCurrentSpeedModifier() const;
+
+protected:
+
+	/** time stamp of the move in MoveAutonomous, negative outside of it */
+	float MoveTimeStamp;
+
+	/** true if moves of this character are predicted by a remote owning client */
+	bool IsSpeedModifierPredicted() const;
+
+	/** client time stamp of the move being performed */
+	float GetSpeedModifierTimeStamp() const;
+
+	/** scheduled speed modifier, kept and replicated by the owning character */
+	FScheduledSpeedModifier* GetScheduledSpeedModifier() const;
 };
 
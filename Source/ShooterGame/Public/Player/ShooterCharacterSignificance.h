@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterTypes.h"
+#include "ShooterCharacterSignificance.generated.h"
+
+class AShooterCharacter;
+
+/** Sorts characters into significance tiers by their distance to the local players and if they were rendered,
+ * and lowers the tick rate of the characters that matter less.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UShooterCharacterSignificance : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** Start updating the significance of the character */
+	void AddCharacter(AShooterCharacter* Character);
+
+private:
+	/** Tier of the character for the given local views, no views means there are no local players */
+	EShooterCharacterSignificance::Type GetSignificance(const AShooterCharacter* Character, const TArray<FVector, TInlineAllocator<4>>& ViewLocations) const;
+
+	/** Actor tick interval used for the tier */
+	float GetTickInterval(EShooterCharacterSignificance::Type Significance) const;
+
+	/** Time in seconds between significance updates */
+	UPROPERTY(config)
+	float UpdateInterval = 0.25f;
+
+	/** Characters on screen within this distance are High */
+	UPROPERTY(config)
+	float HighDistance = 2500.f;
+
+	/** Characters within this distance are at least Medium */
+	UPROPERTY(config)
+	float MediumDistance = 6000.f;
+
+	/** Tick intervals of the tiers, High always ticks every frame */
+	UPROPERTY(config)
+	float MediumTickInterval = 0.05f;
+
+	UPROPERTY(config)
+	float LowTickInterval = 0.25f;
+
+	UPROPERTY(config)
+	float ServerOnlyTickInterval = 0.1f;
+
+	TArray<TWeakObjectPtr<AShooterCharacter>> Characters;
+
+	float UpdateAccumulator = 0.f;
+};
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterLagCompensation.generated.h"
+
+class AShooterCharacter;
+
+/** Hit box history of every character, HistoryLength samples per character in one block of the sample arrays */
+struct FLagCompensationStorage
+{
+	TArray<TWeakObjectPtr<AShooterCharacter>> Characters;
+	/** Index of the newest sample in the block of each character */
+	TArray<int32> Heads;
+	/** Number of valid samples in the block of each character */
+	TArray<int32> Counts;
+
+	TArray<float> SampleTimes;
+	TArray<FVector> SampleCenters;
+	TArray<FVector> SampleExtents;
+
+	int32 Num() const
+	{
+		return Characters.Num();
+	}
+
+	int32 Add(AShooterCharacter* Character, int32 HistoryLength);
+
+	/** Remove the character by moving the last one into its place */
+	void RemoveAtSwap(int32 Index, int32 HistoryLength);
+
+	void Reset();
+};
+
+/** Keeps a short history of the hit boxes of all characters on the server,
+ * so hits reported by clients can be checked against where the target was when the client shot.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UShooterLagCompensation : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** [server] Start recording the hit box of the character */
+	void AddCharacter(AShooterCharacter* Character);
+
+	/** [server] Stop recording the hit box of the character */
+	void RemoveCharacter(AShooterCharacter* Character);
+
+	/** [server] Estimated world time the shooter saw the world at when shooting now */
+	float GetClientTime(const APawn* Shooter) const;
+
+	/** [server] Hit box of the character at the given world time, false if there is no history of it */
+	bool GetHitBoxAt(const AShooterCharacter* Character, float Time, FBox& OutHitBox) const;
+
+private:
+	/** Drop the character and history in the slot, the last slot is moved into it */
+	void RemoveSlot(int32 Slot);
+
+	/** Store the current hit box of each character */
+	void RecordSamples();
+
+	/** Number of samples kept for each character, one per frame */
+	UPROPERTY(config)
+	int32 HistoryLength = 64;
+
+	/** Max time in seconds a hit is rewound by, longer pings are checked against older positions */
+	UPROPERTY(config)
+	float MaxRewindTime = 0.5f;
+
+	/** Slot of each character in the storage */
+	TMap<const AShooterCharacter*, int32> CharacterSlots;
+
+	FLagCompensationStorage Storage;
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterReplicationVisibility.generated.h"
+
+class AShooterCharacter;
+
+typedef TPair<const APlayerController*, const AShooterCharacter*> FReplicationVisibilityKey;
+
+/** Last known line of sight from one viewer to one character */
+struct FReplicationVisibilityEntry
+{
+	/** pointers the entry was added for, only used to find it */
+	FReplicationVisibilityKey Key;
+	TWeakObjectPtr<APlayerController> Viewer;
+	TWeakObjectPtr<AShooterCharacter> Target;
+	/** true if none of the check points of the target can be seen by the viewer */
+	bool bHidden;
+	/** world time of the last refresh */
+	float UpdateTime;
+	/** world time the answer was last asked for */
+	float QueryTime;
+	/** async traces of the refresh in flight */
+	TArray<FTraceHandle, TInlineAllocator<8>> PendingTraces;
+	uint64 IssuedFrame;
+};
+
+/** Answers if a character is hidden from a viewer for pausing its replication, from a cache.
+ * The cache is refreshed a few pairs at a time within a trace budget per frame,
+ * so the trace cost no longer grows with each replication evaluation of every viewer and character pair.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UShooterReplicationVisibility : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** [server] Cached answer if the target is hidden from the viewer, pairs seen for the first time count as visible until refreshed */
+	bool IsHiddenFrom(APlayerController* Viewer, AShooterCharacter* Target);
+
+private:
+	/** Refresh entries that are due, round robin, until the trace budget of the frame is spent */
+	void RefreshEntries(float CurrentTime);
+
+	/** Trace the check points of the entry, returns the number of traces used */
+	int32 RefreshEntry(FReplicationVisibilityEntry& Entry, float CurrentTime);
+
+	/** Collect the async traces of every entry in flight, whether or not the refresh budget reaches them this frame */
+	void CollectAsyncRefreshes();
+
+	/** Collect the async traces of the entry, returns false while they are still in flight */
+	bool FinishAsyncRefresh(FReplicationVisibilityEntry& Entry);
+
+	/** Drop the entry, the last one is moved into its place */
+	void RemoveEntry(int32 Index);
+
+	/** Time in seconds an answer is used before it is traced again */
+	UPROPERTY(config)
+	float RefreshInterval = 0.2f;
+
+	/** Max number of line traces per frame */
+	UPROPERTY(config)
+	int32 MaxTracesPerFrame = 128;
+
+	/** Time in seconds an entry is kept without being asked for */
+	UPROPERTY(config)
+	float EntryTimeout = 2.f;
+
+	TArray<FReplicationVisibilityEntry> Entries;
+
+	/** Index into Entries for each viewer and target pair */
+	TMap<FReplicationVisibilityKey, int32> EntryIndices;
+
+	/** Pairs of the entries with async traces in flight */
+	TArray<FReplicationVisibilityKey> InFlightKeys;
+
+	/** Next entry to look at for a refresh */
+	int32 RefreshCursor = 0;
+};
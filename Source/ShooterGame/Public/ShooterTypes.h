@@ -41,6 +41,22 @@ namespace EShooterHudPosition
 	};
 }
 
+/** how much a character matters to the local players, see UShooterCharacterSignificance */
+namespace EShooterCharacterSignificance
+{
+	enum Type
+	{
+		/** locally controlled, or close and on screen */
+		High,
+		/** on screen or close */
+		Medium,
+		/** far away and off screen */
+		Low,
+		/** no local players, nothing is seen or heard */
+		ServerOnly,
+	};
+}
+
 /** keep in sync with ShooterImpactEffect */
 UENUM()
 namespace EShooterPhysMaterialType
@@ -153,10 +169,65 @@ private:
 	UPROPERTY()
 	FRadialDamageEvent RadialDamageEvent;
 
+	/** Hit location of a point or radial event relative to the hit actor, this is what gets replicated instead of the events */
+	FVector_NetQuantize RelHitLocation;
+
+	/** Direction the hit pushes the hit actor in, shot direction of point damage or away from the origin of radial damage */
+	FVector_NetQuantizeNormal Momentum;
+
+	/** [client] the received events are still relative to the hit actor, see ResolveHitLocation */
+	bool bRelativeHitLocation;
+
 public:
 	FTakeHitInfo();
 
 	FDamageEvent& GetDamageEvent();
-	void SetDamageEvent(const FDamageEvent& DamageEvent);
+	void SetDamageEvent(const FDamageEvent& DamageEvent, const FVector& HitActorLocation);
 	void EnsureReplication();
-};
\ No newline at end of file
+
+	/** [client] move the received events to world space, call before the damage event is used */
+	void ResolveHitLocation(const FVector& HitActorLocation);
+
+	/** Packs only what clients need to play the hit: flags, quantized damage and the relative hit location and momentum */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FTakeHitInfo> : public TStructOpsTypeTraitsBase2<FTakeHitInfo>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/** Speed modifier change that takes effect at a client move time stamp,
+ * so the owning client and the server apply it to the same moves */
+USTRUCT()
+struct FScheduledSpeedModifier
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** modifier used by moves before TimeStamp */
+	UPROPERTY()
+	float PreviousModifier;
+
+	/** modifier used by moves from TimeStamp on */
+	UPROPERTY()
+	float Modifier;
+
+	/** client move time stamp the change takes effect at */
+	UPROPERTY()
+	float TimeStamp;
+
+	/** get the modifier for a move with the given time stamp */
+	float GetModifierAt(float MoveTimeStamp) const;
+
+	/** defaults */
+	FScheduledSpeedModifier()
+		: PreviousModifier(1.f)
+		, Modifier(1.f)
+		, TimeStamp(0.f)
+	{
+	}
+};
@@ -22,6 +22,12 @@ class USoundNodeLocalPlayer : public USoundNode
 #endif
 	// End USoundNode interface.
 
+	/** [game thread] Tell the audio thread if the actor is locally controlled, only needed when it changes */
+	static void SetLocallyControlled(uint32 ActorID, bool bLocallyControlled);
+
+	/** [game thread] Forget the actor on the audio thread */
+	static void RemoveLocallyControlled(uint32 ActorID);
+
 	static TMap<uint32, bool>& GetLocallyControlledActorCache()
 	{
 		check(IsInAudioThread());
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/SplineComponent.h"
 #include "Components/SplineMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "GameFramework/Actor.h"
 #include "SplineActor.generated.h"
 
@@ -15,6 +16,12 @@ enum class ESplineMeshType: uint8 {
   End      UMETA(DisplayName = "Ending Mesh"),
 };
 
+UENUM(BlueprintType)
+enum class ESplineRenderMode: uint8 {
+  SplineMeshes    UMETA(DisplayName = "Spline Mesh Per Segment"),
+  InstancedMeshes    UMETA(DisplayName = "Instanced Mesh Per Segment Type"),
+};
+
 USTRUCT(BlueprintType)
 struct FSplineMeshDetails : public FTableRowBase
 {
@@ -45,9 +52,13 @@ public:
 	void AddNode(const FVector& Position);
 	/** Clear all nodes from the spline component */
 	void ClearNodes();
-	/** Refresh the spline and add the spline meshes at the corresponding spline points */
+	/** Refresh the spline and place the meshes of the render mode at the corresponding spline points,
+	 * meshes are reused between calls and the ones that are not needed are hidden */
 	void UpdateSpline();
 
+	/** Instanced mesh that draws the segments of the given type, nullptr if none was needed yet */
+	UInstancedStaticMeshComponent* GetInstancedMesh(ESplineMeshType Type) const;
+
 	/** Actual Spline component that this class provides functionalities for */
 	UPROPERTY(VisibleAnywhere, Category = "Spline")
 	USplineComponent* SplineComponent;
@@ -58,4 +69,29 @@ public:
 
 	UPROPERTY(EditAnywhere,BlueprintReadWrite, Category = "Spline")
 	int NodeCount = 3;
+
+	/** How the segments are drawn, a bent spline mesh each or one straight instance each batched by mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spline")
+	ESplineRenderMode RenderMode = ESplineRenderMode::SplineMeshes;
+
+protected:
+	/** Return the mesh details used for the given segment, nullptr if there is no default mesh */
+	const FSplineMeshDetails* GetSegmentMeshDetails(int32 Segment, int32 SegmentCount, ESplineMeshType& OutType) const;
+
+	/** Place a spline mesh on each of the first SegmentCount segments and hide the rest */
+	void UpdateSplineMeshes(int32 SegmentCount);
+
+	/** Place an instance on each of the first SegmentCount segments and clear the rest */
+	void UpdateInstancedMeshes(int32 SegmentCount);
+
+	/** Return the pooled spline mesh at Index, creating and registering it if the pool is smaller */
+	USplineMeshComponent* GetPooledSplineMesh(int32 Index);
+
+	/** Spline meshes created so far, the first ones are used for the current spline points */
+	UPROPERTY(Transient)
+	TArray<USplineMeshComponent*> SplineMeshPool;
+
+	/** One instanced mesh per segment type, used by the instanced render mode */
+	UPROPERTY(Transient)
+	TMap<ESplineMeshType, UInstancedStaticMeshComponent*> InstancedMeshes;
 };
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Path of a projectile under constant gravity and without drag, in closed form.
+ * Time is split into the same simulation steps PredictProjectilePath uses, but collision
+ * is first swept along long chords that are inflated to contain the arc. Only the chord that
+ * hits something is refined with single steps, so the hit matches a stepped prediction
+ * while most of the path costs one sweep per chord.
+ */
+struct SHOOTERGAME_API FBallisticPath
+{
+	FBallisticPath(const FVector& InOrigin, const FVector& InVelocity, float InGravityZ, float InMaxTime, float InSimFrequency);
+
+	/** Location at the given time */
+	FVector GetLocation(float Time) const;
+
+	/** Time of the given simulation step, the last step may be shorter than the others */
+	float GetStepTime(int32 Step) const;
+
+	/** Number of simulation steps until the max time */
+	int32 GetNumSteps() const
+	{
+		return NumSteps;
+	}
+
+	/** Number of steps a chord can span before the arc is further than Tolerance away from it */
+	int32 GetStepStride(float Tolerance) const;
+
+	/** Largest distance between the arc and the chord from FirstStep to LastStep */
+	float GetChordSag(int32 FirstStep, int32 LastStep) const;
+
+	/** Sweep the path with chords of Stride steps, refine the first chord that hits.
+	 * Returns true on a hit, OutHitStep is the step the hit happened in. */
+	bool Sweep(const UWorld* World, int32 Stride, float Radius, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FHitResult& OutHit, int32& OutHitStep) const;
+
+	/** Sweep the single steps from FirstStep to LastStep, returns true on a hit in one of them */
+	bool SweepSteps(const UWorld* World, int32 FirstStep, int32 LastStep, float Radius, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FHitResult& OutHit, int32& OutHitStep) const;
+
+	/** Add the path points up to EndStep, placed Stride steps apart and always including EndStep */
+	void GetPoints(int32 EndStep, int32 Stride, TArray<FVector>& OutPoints) const;
+
+private:
+	FVector Origin;
+	FVector Velocity;
+	float GravityZ;
+	float MaxTime;
+	float StepTime;
+	int32 NumSteps;
+};
@@ -9,6 +9,59 @@
 class UProjectileMovementComponent;
 class USphereComponent;
 
+/** Everything a client needs to simulate the flight of a projectile by itself */
+USTRUCT()
+struct FProjectileSpawnRecord
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** location the projectile was fired from */
+	UPROPERTY()
+	FVector_NetQuantize10 Origin;
+
+	/** direction the projectile was fired in */
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	/** server world time the projectile was fired at */
+	UPROPERTY()
+	float ServerSpawnTime;
+
+	/** speed the projectile was fired with */
+	UPROPERTY()
+	float Speed;
+
+	/** gravity scale of the flight */
+	UPROPERTY()
+	float GravityScale;
+
+	/** life time of the projectile in seconds */
+	UPROPERTY()
+	float LifeTime;
+
+	/** defaults */
+	FProjectileSpawnRecord()
+		: Origin(ForceInitToZero)
+		, Direction(ForceInitToZero)
+		, ServerSpawnTime(0.f)
+		, Speed(0.f)
+		, GravityScale(0.f)
+		, LifeTime(0.f)
+	{
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FProjectileSpawnRecord> : public TStructOpsTypeTraitsBase2<FProjectileSpawnRecord>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
 // 
 UCLASS(Abstract, Blueprintable)
 class AShooterProjectile : public AActor
@@ -26,9 +79,39 @@ class AShooterProjectile : public AActor
 	/** setup velocity */
 	void InitVelocity(FVector& ShootDirection);
 
+	/** [server] fire this pooled projectile again from the given transform, owner and instigator are already set */
+	void ReuseProjectile(const FTransform& SpawnTransform, FVector& ShootDirection);
+
+	/** [server] hide this projectile and stop replicating it while it is pooled */
+	void DeactivateProjectile();
+
 	/** handle stop after hit */
 	UFUNCTION()
 	virtual void OnStopOnImpact(const FHitResult& HitResult);
+
+	/** [server] explode when the life time ran out */
+	void OnLifeTimeEnded();
+
+	/** [server] move to the location computed by the batched projectile simulation */
+	void ApplySimulatedMovement(const FVector& NewLocation, const FVector& NewVelocity);
+
+	/** [local] mark this as a projectile the owning client fired ahead of the server, it never explodes by itself */
+	void InitPredictedProjectile(uint8 InPredictionId);
+
+	/** [server] set the id of the predicted projectile the owning client should replace with this one, 0 for none */
+	void SetPredictionId(uint8 InPredictionId);
+
+	/** id of the predicted projectile this one belongs to, 0 for none */
+	uint8 GetPredictionId() const
+	{
+		return PredictionId;
+	}
+
+	/** did it explode? */
+	bool HasExploded() const
+	{
+		return bExploded;
+	}
 protected:
 	/** movement component */
 	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
@@ -41,6 +124,42 @@ protected:
 	UPROPERTY(VisibleDefaultsOnly, Category=Projectile)
 	UParticleSystemComponent* ParticleComp;
 
+	/** Let UShooterProjectileSimulation move this projectile on the server instead of its tick and movement component,
+	 * clients still move it with the movement component from the replicated velocity.
+	 * Ignored for projectiles that bounce, the simulation explodes them on their first hit */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bUseBatchedSimulation;
+
+	/** Replicate only where and when this projectile was fired and where it exploded, instead of its movement.
+	 * Clients simulate the flight from the spawn record alone, the owning weapon may not be relevant to them */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bReplicateSpawnRecord;
+
+	/** where and when this projectile was fired, only replicated with bReplicateSpawnRecord */
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_SpawnRecord)
+	FProjectileSpawnRecord SpawnRecord;
+
+	/** location of the projectile when it exploded, only replicated with bReplicateSpawnRecord */
+	UPROPERTY(Transient, Replicated)
+	FVector_NetQuantize10 ExplosionLocation;
+
+	/** normal of the surface the projectile exploded on, zero if it exploded in the air */
+	UPROPERTY(Transient, Replicated)
+	FVector_NetQuantizeNormal ExplosionNormal;
+
+	/** [server] store the spawn record of the current flight */
+	void RecordSpawn();
+
+	/** [server] store where the projectile explodes */
+	void RecordExplosion(const FVector& Normal);
+
+	/** [client] simulate the flight from the spawn record, caught up to the current server time */
+	UFUNCTION()
+	void OnRep_SpawnRecord();
+
+	/** [server] start moving with the batched simulation if this projectile uses it */
+	void StartBatchedSimulation();
+
 	/** The status effects this projectile will apply to targets, can be modified from BPs*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<FStatusEffectData> StatusEffects;
@@ -51,6 +170,12 @@ private:
 	/** Life Time of this Projectile */
 	float LifeTimeTimer;
 
+	/** Handle for returning this projectile to the pool after the explosion was shown */
+	FTimerHandle TimerHandle_ReturnToPool;
+
+	/** [server] give this projectile back to the projectile pool */
+	void ReturnToPool();
+
 protected:
 
 	/** effects for explosion */
@@ -71,16 +196,60 @@ protected:
 	UFUNCTION()
 	void OnRep_Exploded();
 
+	/** number of times this projectile was reused from the pool */
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_PoolGeneration)
+	uint8 PoolGeneration;
+
+	/** [client] projectile was reused */
+	UFUNCTION()
+	void OnRep_PoolGeneration();
+
+	/** id of the predicted projectile this one replaces on the owning client */
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_PredictionId)
+	uint8 PredictionId;
+
+	/** [client] the projectile this one replaces is known */
+	UFUNCTION()
+	void OnRep_PredictionId();
+
+	/** true for the local projectile the owning client fired ahead of the server */
+	bool bPredicted;
+
+	/** seconds a predicted projectile takes to blend onto the replicated one */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float PredictionCorrectionTime;
+
+	/** replicated projectile a predicted one is blending onto */
+	TWeakObjectPtr<AShooterProjectile> ReconcileTarget;
+
+	/** progress of the blend onto ReconcileTarget, 0 to 1 */
+	float ReconcileAlpha;
+
+	/** [client] take over the predicted projectile of the owning weapon with the same id */
+	void ClaimPredictedProjectile();
+
+	/** [local] blend a predicted projectile onto its replicated one, and hand over once it got there */
+	void TickReconcile(float DeltaSeconds);
+
+	/** read the config of the weapon that owns this projectile */
+	void InitProjectileConfig();
+
+	/** [local + server] bring components back to the state of a newly spawned projectile */
+	void ResetProjectileState();
+
 	/** trigger an explosion on hit */
 	void Explode(const FHitResult& Impact);
 	
 	/** Explode on a given position without the need to hit anything */
 	void Explode(const FVector& ExplosionPoint);
 	
-	/** Actual Explosion method */
-	virtual class AShooterExplosionEffect* const Explosion(const FVector& ExplosionPoint, const FRotator& Rotation);
+	/** Apply radial damage and status effects to everything in the explosion radius, with a single overlap */
+	void ResolveExplosion(const FVector& ExplosionPoint);
+
+	/** Actual Explosion method, the effect is played through the effect pool */
+	virtual void Explosion(const FVector& ExplosionPoint, const FHitResult& SurfaceHit);
 	
-	/** shutdown projectile and prepare for destruction */
+	/** shutdown projectile and prepare for destruction, or for the pool */
 	void DisableAndDestroy();
 
 	/** update velocity on client */
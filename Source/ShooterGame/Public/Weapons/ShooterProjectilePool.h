@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterProjectilePool.generated.h"
+
+class AShooterProjectile;
+
+/** Projectiles of one class waiting to be fired again */
+USTRUCT()
+struct FShooterProjectilePoolList
+{
+	GENERATED_BODY()
+
+	/** hidden and dormant projectiles */
+	UPROPERTY()
+	TArray<AShooterProjectile*> Projectiles;
+};
+
+/** Keeps projectiles that are done around and fires them again instead of spawning new ones.
+ * Pooled projectiles stay in the world hidden and net dormant, so clients keep their copy
+ * too and only receive the changed state when one is reused.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UShooterProjectilePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	/** [server] Fire a projectile of the given class, a pooled one is reused if there is one */
+	AShooterProjectile* FireProjectile(TSubclassOf<AShooterProjectile> ProjectileClass, const FTransform& SpawnTransform, FVector ShootDirection, AActor* ProjectileOwner, APawn* ProjectileInstigator);
+
+	/** [server] Take back a projectile that is done, it is destroyed if the pool of its class is full */
+	void ReleaseProjectile(AShooterProjectile* Projectile);
+
+private:
+	/** Max number of projectiles kept for each class */
+	UPROPERTY(config)
+	int32 MaxPooledProjectiles = 32;
+
+	/** Pooled projectiles by class */
+	UPROPERTY(Transient)
+	TMap<UClass*, FShooterProjectilePoolList> Pools;
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterProjectileSimulation.generated.h"
+
+class AShooterProjectile;
+
+/** Packed state of the projectiles in flight, one index into the parallel arrays per projectile */
+struct FProjectileSimulationStorage
+{
+	TArray<TWeakObjectPtr<AShooterProjectile>> Projectiles;
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<float> GravityZs;
+	TArray<float> MaxSpeeds;
+	TArray<float> Radii;
+	/** Remaining life time in seconds */
+	TArray<float> LifeTimes;
+	/** Responses of the projectile collision, used by its sweeps */
+	TArray<FCollisionResponseParams> Responses;
+
+	int32 Num() const
+	{
+		return Projectiles.Num();
+	}
+
+	void RemoveAtSwap(int32 Index);
+
+	void Reset();
+};
+
+/** Moves the server side of projectiles that use batched simulation in one pass per frame,
+ * instead of one actor tick and one projectile movement component each.
+ * Impacts and expired life times are handed back to the projectile, so it explodes through its usual functions.
+ */
+UCLASS()
+class SHOOTERGAME_API UShooterProjectileSimulation : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** [server] Start moving the projectile from its current location with the given velocity */
+	void AddProjectile(AShooterProjectile* Projectile, const FVector& Velocity, float GravityZ, float MaxSpeed, float Radius, float LifeTime, const FCollisionResponseParams& Response);
+
+	/** [server] Stop moving the projectile */
+	void RemoveProjectile(AShooterProjectile* Projectile);
+
+	/** Move a projectile by DeltaTime without collision, the same way the projectile movement component does */
+	static void IntegrateProjectile(FVector& Location, FVector& Velocity, float GravityZ, float MaxSpeed, float DeltaTime);
+
+	/** Number of projectiles in flight */
+	int32 GetNumProjectiles() const
+	{
+		return Storage.Num();
+	}
+
+private:
+	/** Advance every projectile by DeltaTime, fills the projectiles that hit something or ran out of life time */
+	void StepProjectiles(float DeltaTime, TArray<TPair<TWeakObjectPtr<AShooterProjectile>, FHitResult>>& OutImpacts, TArray<TWeakObjectPtr<AShooterProjectile>>& OutExpired);
+
+	FProjectileSimulationStorage Storage;
+};
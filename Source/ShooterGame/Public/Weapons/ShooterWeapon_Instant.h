@@ -22,6 +22,55 @@ struct FInstantHitInfo
 	int32 RandomSeed;
 };
 
+/** One hit of a batched hit notify, reduced to what the server needs to verify it */
+USTRUCT()
+struct FInstantHitBatchEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** hit actor, null for world geometry and for actors the server doesn't know */
+	UPROPERTY()
+	AActor* HitActor;
+
+	UPROPERTY()
+	FVector_NetQuantize ImpactPoint;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal ImpactNormal;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal ShootDir;
+
+	UPROPERTY()
+	int32 RandomSeed;
+
+	/** reticle spread in hundredths of a degree */
+	UPROPERTY()
+	uint16 ReticleSpread;
+
+	/** time in milliseconds between the shot and sending its batch */
+	UPROPERTY()
+	uint16 ShotAge;
+
+	UPROPERTY()
+	FName BoneName;
+
+	UPROPERTY()
+	TWeakObjectPtr<class UPhysicalMaterial> PhysMaterial;
+
+	FInstantHitBatchEntry()
+		: HitActor(nullptr)
+		, ImpactPoint(ForceInitToZero)
+		, ImpactNormal(ForceInitToZero)
+		, ShootDir(ForceInitToZero)
+		, RandomSeed(0)
+		, ReticleSpread(0)
+		, ShotAge(0)
+		, BoneName(NAME_None)
+	{
+	}
+};
+
 USTRUCT()
 struct FInstantWeaponData
 {
@@ -47,22 +96,42 @@ struct FInstantWeaponData
 	UPROPERTY(EditDefaultsOnly, Category=WeaponStat)
 	float WeaponRange;
 
-	/** damage amount */
+	/** damage amount, dealt by each pellet */
 	UPROPERTY(EditDefaultsOnly, Category=WeaponStat)
 	int32 HitDamage;
 
+	/** number of pellets fired with each shot */
+	UPROPERTY(EditDefaultsOnly, Category=WeaponStat, meta=(ClampMin="1"))
+	int32 PelletCount;
+
+	/** spread of the pellets around the shot direction (degrees), only used with more than one pellet */
+	UPROPERTY(EditDefaultsOnly, Category=Accuracy)
+	float PelletSpread;
+
 	/** type of damage */
 	UPROPERTY(EditDefaultsOnly, Category=WeaponStat)
 	TSubclassOf<UDamageType> DamageType;
 
-	/** hit verification: scale for bounding box of hit actor */
+	/** hit verification: scale for bounding box of hit actor, used when there is no hit box history of it */
 	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
 	float ClientSideHitLeeway;
 
+	/** hit verification: distance a hit may be outside of the rewound hit box of a character */
+	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
+	float RewoundHitTolerance;
+
 	/** hit verification: threshold for dot product between view direction and hit direction */
 	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
 	float AllowedViewDotHitDir;
 
+	/** hit verification: time in seconds a client gathers hits before sending them to the server in one batch, 0 sends each hit on its own */
+	UPROPERTY(EditDefaultsOnly, Category=HitVerification)
+	float HitNotifyBatchTime;
+
+	/** hit verification: max number of hits in one batch, a full batch is sent right away */
+	UPROPERTY(EditDefaultsOnly, Category=HitVerification, meta=(ClampMin="1"))
+	int32 HitNotifyBatchSize;
+
 	/** defaults */
 	FInstantWeaponData()
 	{
@@ -72,12 +141,31 @@ struct FInstantWeaponData
 		FiringSpreadMax = 10.0f;
 		WeaponRange = 10000.0f;
 		HitDamage = 10;
+		PelletCount = 1;
+		PelletSpread = 8.0f;
 		DamageType = UDamageType::StaticClass();
 		ClientSideHitLeeway = 200.0f;
+		RewoundHitTolerance = 30.0f;
 		AllowedViewDotHitDir = 0.8f;
+		HitNotifyBatchTime = 0.1f;
+		HitNotifyBatchSize = 8;
 	}
 };
 
+/** Pellets of one shot, kept until all of their traces are done */
+struct FInstantPelletShot
+{
+	FVector Origin;
+	int32 RandomSeed;
+	float ReticleSpread;
+	/** only play the effects, the shot was fired on another machine */
+	bool bSimulated;
+	int32 NumPending;
+	TArray<FVector, TInlineAllocator<16>> ShootDirs;
+	TArray<FTraceHandle, TInlineAllocator<16>> TraceHandles;
+	TArray<FHitResult, TInlineAllocator<16>> Impacts;
+};
+
 // A weapon where the damage impact occurs instantly upon firing
 UCLASS(Abstract)
 class AShooterWeapon_Instant : public AShooterWeapon
@@ -117,6 +205,18 @@ protected:
 	/** current spread from continuous firing */
 	float CurrentFiringSpread;
 
+	/** [local] hits waiting to be sent to the server */
+	TArray<FInstantHitBatchEntry> PendingHitNotifies;
+
+	/** [local] world time of each pending hit */
+	TArray<float> PendingHitNotifyTimes;
+
+	/** Handle for efficient management of FlushHitNotifies timer */
+	FTimerHandle TimerHandle_FlushHitNotifies;
+
+	/** pellet shots waiting for their async traces */
+	TArray<FInstantPelletShot> PendingPelletShots;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Weapon usage
 
@@ -128,6 +228,31 @@ protected:
 	UFUNCTION(unreliable, server, WithValidation)
 	void ServerNotifyMiss(FVector_NetQuantizeNormal ShootDir, int32 RandomSeed, float ReticleSpread);
 
+	/** server notified of a batch of hits from client to verify */
+	UFUNCTION(reliable, server, WithValidation)
+	void ServerNotifyHits(const TArray<FInstantHitBatchEntry>& Hits);
+
+	/** [server] verify a hit reported by the client, bWasFiring tells if the weapon was firing when it was shot, ShotAge how long before the notify it was shot */
+	void VerifyClientHit(const FHitResult& Impact, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread, bool bWasFiring, float ShotAge);
+
+	/** [local] notify the server of a hit, with the next batch when batching is enabled */
+	void QueueHitNotify(const FHitResult& Impact, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread);
+
+	/** [local] send the gathered hits to the server */
+	void FlushHitNotifies();
+
+	/** directions of the pellets of one shot, from the same seed on every machine */
+	void GetPelletDirections(const FVector& AimDir, int32 RandomSeed, float ReticleSpread, TArray<FVector, TInlineAllocator<16>>& OutShootDirs) const;
+
+	/** trace all pellets of a shot together, they are processed once every trace is done */
+	void FirePellets(const FVector& Origin, const FVector& AimDir, int32 RandomSeed, float ReticleSpread, bool bSimulated);
+
+	/** async trace of a pellet is done */
+	void OnPelletTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceData);
+
+	/** process the pellets of a shot, the server is notified of all of them at once */
+	void ProcessPelletHits(const FInstantPelletShot& Shot);
+
 	/** process the instant hit and notify the server if necessary */
 	void ProcessInstantHit(const FHitResult& Impact, const FVector& Origin, const FVector& ShootDir, int32 RandomSeed, float ReticleSpread);
 
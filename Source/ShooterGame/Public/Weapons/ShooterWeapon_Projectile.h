@@ -4,6 +4,7 @@
 
 #include "ShooterWeapon.h"
 #include "SplineActor.h"
+#include "BallisticPath.h"
 #include "GameFramework/DamageType.h" // for UDamageType::StaticClass()
 #include "ShooterWeapon_Projectile.generated.h"
 
@@ -53,6 +54,97 @@ struct FProjectileWeaponData
 	}
 };
 
+/** Everything the predicted trajectory of a projectile depends on */
+struct FTrajectoryInputs
+{
+	/** muzzle location the path starts at */
+	FVector Origin;
+
+	/** aim direction */
+	FVector Direction;
+
+	/** launch speed */
+	float Speed;
+
+	/** gravity applied to the projectile */
+	float GravityZ;
+
+	/** true if both inputs give the same path within the given tolerances */
+	bool IsNearlyEqual(const FTrajectoryInputs& Other, float LocationTolerance, float AimTolerance) const;
+
+	/** defaults */
+	FTrajectoryInputs()
+		: Origin(ForceInitToZero)
+		, Direction(ForceInitToZero)
+		, Speed(0.f)
+		, GravityZ(0.f)
+	{
+	}
+};
+
+/** Inputs of the last predicted trajectory, used to skip predictions that would give the same path */
+struct FTrajectoryCache
+{
+	/** inputs the drawn path was predicted with */
+	FTrajectoryInputs Inputs;
+
+	/** bounds of the path, expanded by the projectile radius */
+	FBox Bounds;
+
+	/** movable colliders inside Bounds and their locations at the last check */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Colliders;
+	TArray<FVector> ColliderLocations;
+
+	/** world time of the last collider check */
+	float LastColliderCheckTime;
+
+	/** false if there is no path to reuse */
+	bool bValid;
+
+	/** defaults */
+	FTrajectoryCache()
+		: Bounds(ForceInit)
+		, LastColliderCheckTime(0.f)
+		, bValid(false)
+	{
+	}
+};
+
+/** Sweeps of a trajectory that were issued with the async trace API, one per chord of FBallisticPath */
+struct FTrajectoryTraceBatch
+{
+	/** inputs the path is predicted with */
+	FTrajectoryInputs Inputs;
+
+	/** simulation steps per chord, chord i sweeps from step i * Stride */
+	int32 Stride;
+
+	/** async sweep of each chord */
+	TArray<FTraceHandle> Handles;
+
+	/** frame the sweeps were issued in, their results can only be read in the next frame */
+	uint64 IssuedFrame;
+
+	/** true while sweeps are in flight */
+	bool IsActive() const
+	{
+		return Handles.Num() > 0;
+	}
+
+	/** drop the sweeps in flight */
+	void Reset()
+	{
+		Handles.Reset();
+	}
+
+	/** defaults */
+	FTrajectoryTraceBatch()
+		: Stride(1)
+		, IssuedFrame(0)
+	{
+	}
+};
+
 // A weapon that fires a visible projectile
 UCLASS(Abstract)
 class AShooterWeapon_Projectile : public AShooterWeapon
@@ -62,9 +154,16 @@ class AShooterWeapon_Projectile : public AShooterWeapon
 	/** apply config on projectile */
 	void ApplyWeaponConfig(FProjectileWeaponData& Data);
 
+	/** [local] remove the predicted projectile with the given id from this weapon and return it */
+	class AShooterProjectile* TakePredictedProjectile(uint8 PredictionId);
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	TMap<ESplineMeshType, FSplineMeshDetails> TrajectorySplineMap;
 
+	/** How the meshes of TrajectorySplineMap are drawn along the trajectory */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
+	ESplineRenderMode TrajectoryRenderMode;
+
 protected:
 
 	virtual EAmmoType GetAmmoType() const override
@@ -76,6 +175,26 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category=Config)
 	FProjectileWeaponData ProjectileConfig;
 
+	/** muzzle movement in cm that is ignored by the trajectory cache */
+	UPROPERTY(EditDefaultsOnly, Category=Trajectory)
+	float TrajectoryLocationTolerance;
+
+	/** aim change in degrees that is ignored by the trajectory cache */
+	UPROPERTY(EditDefaultsOnly, Category=Trajectory)
+	float TrajectoryAimTolerance;
+
+	/** max distance in cm between the drawn trajectory points and the actual arc */
+	UPROPERTY(EditDefaultsOnly, Category=Trajectory)
+	float TrajectoryPointTolerance;
+
+	/** max distance in cm between the arc and the long chords that are swept before refining a hit */
+	UPROPERTY(EditDefaultsOnly, Category=Trajectory)
+	float TrajectoryChordTolerance;
+
+	/** seconds between checks for movable colliders entering the cached trajectory */
+	UPROPERTY(EditDefaultsOnly, Category=Trajectory)
+	float TrajectoryColliderCheckInterval;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Weapon usage
 
@@ -89,16 +208,59 @@ protected:
 
 	virtual void OnUnEquip() override;
 
-	/** Draw Trajectory for the projectile this weapon uses */
+	/** Draw Trajectory for the projectile this weapon uses, the last path is kept while its inputs don't change */
 	void DrawTrajectory();
 	/** Clear Trajectory */
 	void ClearTrajectory();
 
-	/** spawn projectile on server */
+	/** closed form path of the projectile for the given inputs */
+	FBallisticPath GetTrajectoryPath(const FTrajectoryInputs& Inputs) const;
+
+	/** predict the path on the game thread and draw it */
+	void PredictTrajectory(const FTrajectoryInputs& Inputs);
+
+	/** issue the sweeps of the path with the async trace API, the current path stays until they finish */
+	void StartAsyncTrajectory(const FTrajectoryInputs& Inputs);
+
+	/** draw the path of the async sweeps once all of them are done */
+	void FinishAsyncTrajectory();
+
+	/** draw the path up to the hit found in HitStep, or all of it, and cache the inputs it was predicted with */
+	void SetTrajectoryPath(const FTrajectoryInputs& Inputs, const FBallisticPath& Path, const FHitResult* Hit, int32 HitStep);
+
+	/** true if the trajectory has to be predicted again for the given inputs */
+	bool IsTrajectoryDirty(const FTrajectoryInputs& Inputs);
+
+	/** true if a movable collider entered, left or moved inside the cached trajectory bounds */
+	bool HaveTrajectoryCollidersChanged();
+
+	/** store the movable colliders that are inside the cached trajectory bounds */
+	void GatherTrajectoryColliders(TArray<TWeakObjectPtr<UPrimitiveComponent>>& OutColliders, TArray<FVector>& OutLocations) const;
+
+	/** spawn projectile on server, it replaces the predicted projectile with PredictionId on the owning client */
 	UFUNCTION(reliable, server, WithValidation)
-	void ServerFireProjectile(FVector Origin, FVector_NetQuantizeNormal ShootDir);
+	void ServerFireProjectile(FVector Origin, FVector_NetQuantizeNormal ShootDir, uint8 PredictionId);
+
+	/** [local] spawn a projectile that is only shown until the one from the server arrives, returns its id or 0 */
+	uint8 SpawnPredictedProjectile(const FVector& Origin, const FVector& ShootDir);
+
+	/** remote clients show their projectile right away instead of after a round trip */
+	UPROPERTY(EditDefaultsOnly, Category=Config)
+	bool bPredictProjectiles;
 
 private:
 	UPROPERTY()
 	class ASplineActor* TrajectorySplineActor = nullptr;
+
+	/** last drawn trajectory */
+	FTrajectoryCache TrajectoryCache;
+
+	/** async sweeps of the next trajectory */
+	FTrajectoryTraceBatch PendingTrajectory;
+
+	/** predicted projectiles waiting for the ones from the server */
+	TArray<TWeakObjectPtr<class AShooterProjectile>> PredictedProjectiles;
+
+	/** id of the last predicted projectile, never 0 */
+	uint8 LastPredictionId = 0;
 };
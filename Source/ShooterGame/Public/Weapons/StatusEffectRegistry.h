@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "UStatusEffect.h"
+
+/** Empty value used to pass an effect type to a generic callable */
+template<typename EffectType>
+struct TStatusEffectTag
+{
+	using Type = EffectType;
+};
+
+/** Compile time list of effect types, see FStatusEffectRegistry */
+template<typename... EffectTypes>
+struct TStatusEffectTypeList
+{
+	static constexpr int32 Num = sizeof...(EffectTypes);
+
+	/** Call Func with a TStatusEffectTag for each effect type, in list order */
+	template<typename FuncType>
+	static void ForEach(FuncType&& Func)
+	{
+		int32 Expand[] = { 0, (Func(TStatusEffectTag<EffectTypes>()), 0)... };
+		(void)Expand;
+	}
+};
+
+/** Start/Update/End of one effect type, used where the type is only known at runtime */
+struct FStatusEffectKernel
+{
+	typedef void (*FEffectFunction)(UStatusEffectSubsystem&, float, AShooterCharacter*, AShooterCharacter*);
+	typedef void (*FUpdateFunction)(UStatusEffectSubsystem&, float, float, AShooterCharacter*, AShooterCharacter*);
+
+	FEffectFunction Start = nullptr;
+	FUpdateFunction Update = nullptr;
+	FEffectFunction End = nullptr;
+};
+
+/** Every effect type known to the game, new effects only need to be added to this list
+ * with their EStatusEffectType value. An effect type is a stateless kernel providing static Type,
+ * Start, Update and End members, the per instance data lives in UStatusEffectSubsystem
+ * and is passed in on each call. The subsystem keeps one batch per type and updates
+ * each batch with the kernels of its type, so nothing is dispatched per effect.
+ */
+struct SHOOTERGAME_API FStatusEffectRegistry : public TStatusEffectTypeList<
+	FEffectBurn,
+	FEffectSpeed
+>
+{
+	/** Return the kernels of the given type, nullptr if the type is not registered */
+	static const FStatusEffectKernel* GetKernel(EStatusEffectType Type);
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "StatusEffectRegistry.h"
+#include "StatusEffectSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/** Packed storage for the active status effects of one type.
+ * Each effect is a single index into the parallel arrays, removal swaps the last effect into the freed slot.
+ */
+struct FStatusEffectStorage
+{
+	TArray<float> Values;
+	/** Remaining life time in seconds */
+	TArray<float> LifeTimes;
+	/** Effect time passed since the last update of the effect */
+	TArray<float> UnpaidTimes;
+	TArray<TWeakObjectPtr<AShooterCharacter>> Owners;
+	TArray<TWeakObjectPtr<AShooterCharacter>> Targets;
+
+	int32 Num() const
+	{
+		return Values.Num();
+	}
+
+	int32 Add(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target);
+
+	void RemoveAtSwap(int32 Index);
+
+	void Reset();
+};
+
+/** Damage over time waiting to be applied to a target at the end of an update */
+struct FPendingStatusDamage
+{
+	TWeakObjectPtr<AShooterCharacter> Target;
+	/** Character that applied the effects, credited for the damage */
+	TWeakObjectPtr<AShooterCharacter> Owner;
+	float Damage;
+};
+
+/** Owns and updates all status effects of a world in one batched pass per frame,
+ * instead of one UObject and one timer for each applied effect.
+ * Effects are grouped by type and each group is updated with the kernels of its type.
+ * Life times advance on a fixed step clock, each type is updated at its own configured rate.
+ */
+UCLASS(config=Game)
+class SHOOTERGAME_API UStatusEffectSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem interface
+
+	// Begin FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	// End FTickableGameObject interface
+
+	/** Start a new effect on target and schedule its updates,
+	 * or merge it into an effect of the same type on target according to its stacking rule */
+	void AddEffect(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target);
+
+	/** Queue damage for target, summed with the other damage of the same owner on that target during this update */
+	void AddPendingDamage(float Damage, AShooterCharacter* Owner, AShooterCharacter* Target);
+
+	/** Number of active effects in this world */
+	int32 GetNumEffects() const;
+
+private:
+	/** Try to merge the new effect into the effects already on target, returns true if no new effect needs to be added */
+	bool MergeEffect(const FStatusEffectData& Data, AShooterCharacter* Owner, AShooterCharacter* Target);
+
+	/** Advance every effect by one fixed step */
+	void StepEffects(float StepTime);
+
+	/** Advance every effect of one type by one fixed step, updating them when their type is due and removing the expired ones */
+	template<typename FEffectType>
+	void StepBatch(FStatusEffectStorage& Batch, float StepTime);
+
+	/** Rate of the fixed step clock in Hz, life times are resolved with this precision */
+	UPROPERTY(config)
+	float StepRate = 30.f;
+
+	/** Update rate in Hz for each effect type, types that are not listed update once per second */
+	UPROPERTY(config)
+	TMap<EStatusEffectType, float> UpdateRates;
+
+	/** Time not yet consumed by the fixed step clock */
+	float StepAccumulator = 0.f;
+
+	/** Time between two updates of each type */
+	float UpdateIntervals[FStatusEffectRegistry::Num];
+
+	/** Time passed since the last update of each type */
+	float UpdateAccumulators[FStatusEffectRegistry::Num];
+
+	/** Apply the damage queued during the update, one TakeDamage call per target and owner */
+	void ApplyPendingDamage();
+
+	/** Active effects, one batch per registered type indexed by EStatusEffectType */
+	FStatusEffectStorage Batches[FStatusEffectRegistry::Num];
+
+	TArray<FPendingStatusDamage> PendingDamage;
+};
@@ -4,14 +4,31 @@
 
 #include "CoreMinimal.h"
 #include "UStatusEffect.generated.h"
-/** Type of effect that is used primarly for the effect factory to determine which
- *effect to create, add another enum here for new ones*/
+
+class AShooterCharacter;
+class UStatusEffectSubsystem;
+
+/** Type of effect that is used to find the effect kernels in FStatusEffectRegistry,
+ *add another enum here for new ones*/
 UENUM()
 enum class EStatusEffectType: uint8
 {
 	Burn,
 	Speed
 };
+/** How a new effect is merged with the effects of the same type that are already on the target */
+UENUM(BlueprintType)
+enum class EStatusEffectStacking: uint8
+{
+	/** Keep a single effect and extend its life time */
+	Refresh,
+	/** Keep up to MaxStacks effects, once full the one closest to expiring is refreshed */
+	Stack,
+	/** Keep a single effect per direction, a stronger value replaces the current one and a weaker one is ignored.
+	 * Negative and positive values are separate effects, e.g. a slow and a haste are both kept */
+	Strongest
+};
+
 /** Shared data structure for each effect. */
 USTRUCT(BlueprintType)
 struct FStatusEffectData
@@ -23,75 +40,44 @@ struct FStatusEffectData
 
 	/** Data that determines the modification value
 	 * for speed effect this is used as a speed modifier
-	 * for burn effect this represents damage over time*/
+	 * for burn effect this represents damage per second, also dealt once when applied*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float Value;
 
-	/** Life time of this effect */
+	/** Life time of this effect in seconds */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float LifeTime;
-};
 
-/** Status Effect is a temporary modification to the stats of a player
- *They can modify player stats when they are first applied, when they update
- *every second or when their life time ends.
- */
-UCLASS(Abstract)
-class SHOOTERGAME_API UStatusEffect : public UObject
-{
-	GENERATED_BODY()
-	public:
-	virtual ~UStatusEffect() = default;
-
-	/** Initialize data for this UObject */
-	virtual void Init(const FStatusEffectData&, AShooterCharacter* Owner, AShooterCharacter* Target);
-	
-	/** Apply modification to target when this effect is created */
-	virtual void Start() PURE_VIRTUAL(UStatusEffect::Start);
-	
-	/** Apply modification to target in each call*/
-	virtual void Update() PURE_VIRTUAL(UStatusEffect::Start);
-	
-	/** Apply modification to target when life time ends */
-	virtual void End() PURE_VIRTUAL(UStatusEffect::Start);
-
-	const FStatusEffectData& GetEffectData() const
-	{
-		return Data;
-	}
-	/** Timer handle for update in each second*/
-	FTimerHandle EffectTimerHandle;
+	/** How this effect merges with effects of the same type on the target */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EStatusEffectStacking Stacking = EStatusEffectStacking::Stack;
 
-protected:
-	FStatusEffectData Data;
-	UPROPERTY()
-	AShooterCharacter* Owner = nullptr;
-	UPROPERTY()
-	AShooterCharacter* Target = nullptr;
+	/** Max number of effects of this type on one target, only used with Stack */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", EditCondition = "Stacking == EStatusEffectStacking::Stack"))
+	int32 MaxStacks = 5;
 };
 
 /** Applies an initial damage and damage over time status
  **/
-UCLASS()
-class SHOOTERGAME_API UEffectBurn : public UStatusEffect
+struct SHOOTERGAME_API FEffectBurn
 {
-	GENERATED_BODY()
-	public:
-	
-	virtual void Start() override;
-	virtual void Update() override;
-	virtual void End() override;
+	static constexpr EStatusEffectType Type = EStatusEffectType::Burn;
+
+	/** Apply modification to target when this effect is created */
+	static void Start(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target);
+	/** Apply modification to target in each call, DeltaSeconds is the effect time passed since the last call */
+	static void Update(UStatusEffectSubsystem& EffectSubsystem, float Value, float DeltaSeconds, AShooterCharacter* Owner, AShooterCharacter* Target);
+	/** Apply modification to target when life time ends */
+	static void End(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target);
 };
 
 /** Modifies the max speed variable of the target player for given time
  **/
-UCLASS()
-class SHOOTERGAME_API UEffectSpeed : public UStatusEffect
+struct SHOOTERGAME_API FEffectSpeed
 {
-	GENERATED_BODY()
-	public:
-	
-	virtual void Start() override;
-	virtual void Update() override;
-	virtual void End() override;
+	static constexpr EStatusEffectType Type = EStatusEffectType::Speed;
+
+	static void Start(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target);
+	static void Update(UStatusEffectSubsystem& EffectSubsystem, float Value, float DeltaSeconds, AShooterCharacter* Owner, AShooterCharacter* Target);
+	static void End(UStatusEffectSubsystem& EffectSubsystem, float Value, AShooterCharacter* Owner, AShooterCharacter* Target);
 };